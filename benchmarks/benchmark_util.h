@@ -0,0 +1,114 @@
+/**
+ * \file  benchmark_util.h
+ * \date  Created on October 17, 2026
+ * \brief Common output and argument handling for the micro-benchmarks.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_BENCHMARK_UTIL_H_
+#define GUL17_BENCHMARK_UTIL_H_
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace benchmark_util {
+
+/// The result of one benchmark run with the parameters and the measured values.
+struct Result
+{
+    std::string benchmark;
+    std::vector<std::pair<std::string, std::string>> parameters;
+    std::vector<std::pair<std::string, double>> values;
+};
+
+/// Print results as JSON lines instead of a table (--json).
+inline bool json_output = false;
+/// Reduce the number of iterations (--quick).
+inline bool quick = false;
+
+/**
+ * Parse the common command line arguments --json and --quick.
+ * Return false (after printing a usage message) if an unknown argument is found.
+ */
+inline bool parse_arguments(int argc, char* argv[])
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string_view arg{ argv[i] };
+
+        if (arg == "--json")
+        {
+            json_output = true;
+        }
+        else if (arg == "--quick")
+        {
+            quick = true;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--json] [--quick]\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// Print one result, either as a line of a table or as a JSON object on one line.
+inline void print(const Result& result)
+{
+    if (json_output)
+    {
+        std::cout << R"({"benchmark":")" << result.benchmark << '"';
+        for (const auto& [name, value] : result.parameters)
+        {
+            const bool is_number = std::all_of(value.begin(), value.end(),
+                [](char c) { return c >= '0' && c <= '9'; });
+
+            if (is_number)
+                std::cout << ",\"" << name << "\":" << value;
+            else
+                std::cout << ",\"" << name << "\":\"" << value << '"';
+        }
+        for (const auto& [name, value] : result.values)
+            std::cout << ",\"" << name << "\":" << value;
+        std::cout << "}\n";
+        return;
+    }
+
+    std::cout << std::left << std::setw(20) << result.benchmark;
+    for (const auto& [name, value] : result.parameters)
+        std::cout << ' ' << name << '=' << std::setw(8) << value;
+    for (const auto& [name, value] : result.values)
+        std::cout << "  " << name << '=' << std::setprecision(4) << value;
+    std::cout << std::endl;
+}
+
+} // namespace benchmark_util
+
+#endif
+
+// vi:ts=4:sw=4:sts=4:et
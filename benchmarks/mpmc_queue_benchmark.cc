@@ -0,0 +1,173 @@
+/**
+ * \file  mpmc_queue_benchmark.cc
+ * \date  Created on October 17, 2026
+ * \brief Micro-benchmarks comparing MpmcQueue with a mutex-protected SlidingBuffer.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Usage: mpmc_queue_benchmark [--json] [--quick]
+//
+// Measures the throughput of a bounded queue for different numbers of producer and
+// consumer threads. See thread_pool_benchmark.cc for the meaning of the options.
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gul17/cat.h>
+#include <gul17/MpmcQueue.h>
+#include <gul17/SlidingBuffer.h>
+
+#include "benchmark_util.h"
+
+using namespace gul17;
+using benchmark_util::print;
+using benchmark_util::quick;
+using benchmark_util::Result;
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr std::size_t queue_capacity = 1024;
+
+/// A SlidingBuffer used as a bounded queue, with a mutex protecting every access.
+class LockedSlidingBuffer
+{
+public:
+    bool try_push(int value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.filled())
+            return false;
+        buffer_.push_back(value);
+        return true;
+    }
+
+    bool try_pop(int& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (buffer_.empty())
+            return false;
+        value = buffer_.front();
+        buffer_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    SlidingBuffer<int, queue_capacity> buffer_;
+};
+
+/**
+ * Measure how many elements per second a number of producer threads can pass to a
+ * number of consumer threads through the given queue. Both sides spin (with yield) if
+ * the queue is full or empty.
+ */
+template <typename Queue>
+Result measure_throughput(const char* queue_name, std::size_t num_producers,
+    std::size_t num_consumers)
+{
+    const std::size_t num_per_producer = quick ? 10'000 : 1'000'000;
+    const std::size_t num_total = num_producers * num_per_producer;
+
+    auto queue = std::make_unique<Queue>();
+    std::atomic<std::size_t> num_popped{ 0 };
+    std::atomic<bool> go{ false };
+
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i != num_producers; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                while (not go)
+                    std::this_thread::yield();
+
+                for (std::size_t j = 0; j != num_per_producer; ++j)
+                {
+                    while (not queue->try_push(static_cast<int>(j)))
+                        std::this_thread::yield();
+                }
+            });
+    }
+    for (std::size_t i = 0; i != num_consumers; ++i)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                while (not go)
+                    std::this_thread::yield();
+
+                int value;
+                while (num_popped.load(std::memory_order_relaxed) < num_total)
+                {
+                    if (queue->try_pop(value))
+                        num_popped.fetch_add(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+    }
+
+    const auto t0 = Clock::now();
+    go = true;
+
+    for (auto& thread : threads)
+        thread.join();
+
+    const auto seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    Result result;
+    result.benchmark = "queue_throughput";
+    result.parameters = {
+        { "queue", queue_name },
+        { "producers", cat(num_producers) },
+        { "consumers", cat(num_consumers) } };
+    result.values = { { "elements_per_s", static_cast<double>(num_total) / seconds } };
+    return result;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    if (not benchmark_util::parse_arguments(argc, argv))
+        return 1;
+
+    for (const std::size_t num_producers : { 1, 2, 4 })
+    {
+        for (const std::size_t num_consumers : { 1, 2, 4 })
+        {
+            print(measure_throughput<MpmcQueue<int, queue_capacity>>(
+                "MpmcQueue", num_producers, num_consumers));
+            print(measure_throughput<LockedSlidingBuffer>(
+                "mutex+SlidingBuffer", num_producers, num_consumers));
+        }
+    }
+
+    return 0;
+}
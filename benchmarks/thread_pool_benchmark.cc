@@ -0,0 +1,257 @@
+/**
+ * \file  thread_pool_benchmark.cc
+ * \date  Created on October 17, 2026
+ * \brief Micro-benchmarks for the ThreadPool class.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+// Usage: thread_pool_benchmark [--json] [--quick]
+//
+// By default, the results are printed as a table. With --json, each result is printed
+// as a JSON object on a line of its own, which is convenient for regression tracking.
+// --quick reduces the number of iterations (e.g. for a smoke test).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <gul17/cat.h>
+#include <gul17/ThreadPool.h>
+
+#include "benchmark_util.h"
+
+using namespace gul17;
+using namespace std::literals;
+using benchmark_util::print;
+using benchmark_util::quick;
+using benchmark_util::Result;
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+/// Return the given quantile (0...1) of a set of durations in microseconds.
+double get_quantile_us(std::vector<Clock::duration>& durations, double quantile)
+{
+    if (durations.empty())
+        return 0.0;
+
+    const auto idx = static_cast<std::size_t>(
+        quantile * static_cast<double>(durations.size() - 1));
+    std::nth_element(durations.begin(), durations.begin() + idx, durations.end());
+
+    return std::chrono::duration<double, std::micro>(durations[idx]).count();
+}
+
+void add_quantiles(Result& result, std::vector<Clock::duration>& durations)
+{
+    result.values.emplace_back("p50_us", get_quantile_us(durations, 0.50));
+    result.values.emplace_back("p90_us", get_quantile_us(durations, 0.90));
+    result.values.emplace_back("p99_us", get_quantile_us(durations, 0.99));
+    result.values.emplace_back("max_us", get_quantile_us(durations, 1.0));
+}
+
+const char* get_mode_name(bool work_stealing)
+{
+    return work_stealing ? "stealing" : "shared";
+}
+
+/**
+ * Measure how many empty tasks per second a number of producer threads can push
+ * through a pool.
+ */
+Result measure_throughput(std::string_view benchmark, std::size_t num_producers,
+    std::size_t num_workers, bool work_stealing, bool detached)
+{
+    const std::size_t num_tasks_per_producer = quick ? 2'000 : 100'000;
+    const std::size_t num_tasks = num_producers * num_tasks_per_producer;
+
+    ThreadPool::Options options;
+    options.num_threads = num_workers;
+    options.capacity = std::min(num_tasks, ThreadPool::max_capacity);
+    options.work_stealing = work_stealing;
+    auto pool = make_thread_pool(options);
+
+    std::atomic<std::size_t> num_executed{ 0 };
+    std::atomic<bool> go{ false };
+
+    std::vector<std::thread> producers;
+    for (std::size_t i = 0; i != num_producers; ++i)
+    {
+        producers.emplace_back(
+            [&]()
+            {
+                while (not go)
+                    std::this_thread::yield();
+
+                for (std::size_t j = 0; j != num_tasks_per_producer; ++j)
+                {
+                    if (detached)
+                        pool->add_detached_task([&num_executed]() { ++num_executed; });
+                    else
+                        pool->add_task([&num_executed]() { ++num_executed; });
+                }
+            });
+    }
+
+    const auto t0 = Clock::now();
+    go = true;
+
+    for (auto& producer : producers)
+        producer.join();
+    const auto t_submit = Clock::now();
+
+    pool->wait_idle();
+    const auto t_done = Clock::now();
+
+    const auto submit_s = std::chrono::duration<double>(t_submit - t0).count();
+    const auto total_s = std::chrono::duration<double>(t_done - t0).count();
+
+    Result result;
+    result.benchmark = std::string(benchmark);
+    result.parameters = {
+        { "mode", get_mode_name(work_stealing) },
+        { "producers", cat(num_producers) },
+        { "workers", cat(num_workers) } };
+    result.values = {
+        { "submit_per_s", static_cast<double>(num_tasks) / submit_s },
+        { "tasks_per_s", static_cast<double>(num_tasks) / total_s } };
+    return result;
+}
+
+/**
+ * Measure the time between adding a task to an idle pool and its start. This includes
+ * waking up a sleeping worker thread.
+ */
+Result measure_dispatch_latency(bool work_stealing)
+{
+    const std::size_t num_samples = quick ? 200 : 5'000;
+
+    ThreadPool::Options options;
+    options.num_threads = 2;
+    options.work_stealing = work_stealing;
+    auto pool = make_thread_pool(options);
+
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(num_samples);
+
+    for (std::size_t i = 0; i != num_samples; ++i)
+    {
+        // Give the workers time to go to sleep
+        std::this_thread::sleep_for(100us);
+
+        const auto t0 = Clock::now();
+        auto handle = pool->add_task([]() { return Clock::now(); });
+        latencies.push_back(handle.get_result() - t0);
+    }
+
+    Result result;
+    result.benchmark = "dispatch_latency";
+    result.parameters = { { "mode", get_mode_name(work_stealing) } };
+    add_quantiles(result, latencies);
+    return result;
+}
+
+/// Measure how late delayed tasks are started relative to their scheduled start time.
+Result measure_delay_accuracy(Clock::duration delay)
+{
+    const std::size_t num_samples = quick ? 20 : 500;
+
+    auto pool = make_thread_pool(2, num_samples);
+
+    std::vector<ThreadPool::TaskHandle<Clock::duration>> handles;
+    handles.reserve(num_samples);
+
+    // Spread the start times so that the tasks do not compete for the workers
+    auto start_time = Clock::now() + delay;
+    for (std::size_t i = 0; i != num_samples; ++i)
+    {
+        handles.push_back(pool->add_task(
+            [start_time]() { return Clock::now() - start_time; }, start_time));
+        start_time += 200us;
+    }
+
+    std::vector<Clock::duration> lateness;
+    lateness.reserve(num_samples);
+    for (auto& handle : handles)
+        lateness.push_back(handle.get_result());
+
+    Result result;
+    result.benchmark = "delay_accuracy";
+    result.parameters = {
+        { "delay_us", cat(std::chrono::duration_cast<std::chrono::microseconds>(
+            delay).count()) } };
+    add_quantiles(result, lateness);
+    return result;
+}
+
+/// Return 1, 2, 4, ... up to the number of hardware threads (and that number itself).
+std::vector<std::size_t> get_thread_counts()
+{
+    const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < max_threads; n *= 2)
+        counts.push_back(n);
+    counts.push_back(max_threads);
+
+    return counts;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+    if (not benchmark_util::parse_arguments(argc, argv))
+        return 1;
+
+    for (const bool work_stealing : { false, true })
+    {
+        print(measure_throughput("submit_handle", 1, 1, work_stealing, false));
+        print(measure_throughput("submit_detached", 1, 1, work_stealing, true));
+    }
+
+    for (const bool work_stealing : { false, true })
+        print(measure_dispatch_latency(work_stealing));
+
+    for (const auto delay : { 1ms, 10ms, 50ms })
+        print(measure_delay_accuracy(delay));
+
+    const auto thread_counts = get_thread_counts();
+    for (const bool work_stealing : { false, true })
+    {
+        for (const auto num_producers : thread_counts)
+        {
+            for (const auto num_workers : thread_counts)
+            {
+                print(measure_throughput("contention", num_producers, num_workers,
+                    work_stealing, true));
+            }
+        }
+    }
+
+    return 0;
+}
@@ -155,6 +155,77 @@ namespace gul17 {
  * - The library is now licensed under the MIT license. For more details, please refer to
  *   the [README file](https://github.com/gul-cpp/gul17/blob/main/README.md) in the
  *   library repository.
+ * - Add ThreadPool::Options and an overload of make_thread_pool() that accepts them.
+ * - Add an optional work-stealing mode to ThreadPool with per-thread task queues.
+ * - ThreadPool keeps delayed tasks in a min-heap and ready tasks in a separate FIFO
+ *   queue. Dispatching, canceling, and querying tasks no longer scales linearly with the
+ *   number of pending tasks.
+ * - ThreadPool schedules delayed tasks on the steady clock. Start times given as system
+ *   clock time points are converted once when the task is added, and
+ *   ThreadPool::add_task() accepts steady clock time points directly.
+ * - Add ThreadPool::add_periodic_task() for tasks that are executed repeatedly at a
+ *   fixed rate or with a fixed delay, and ThreadPool::PeriodicTaskHandle to stop them.
+ * - Add ThreadPool::add_detached_task() for "fire and forget" tasks without name or
+ *   handle. Small function objects are stored inline in the task queue without any heap
+ *   allocation.
+ * - Add ThreadPool::add_tasks() to enqueue a batch of tasks with a single lock
+ *   acquisition and a single capacity check.
+ * - Add parallel_for() and parallel_reduce() for parallel loops on top of ThreadPool.
+ * - Add ThreadPool::TaskHandle::then() for continuations and ThreadPool::TaskGraph with
+ *   ThreadPool::add_task_graph() for groups of tasks with dependencies. Waiting tasks do
+ *   not block any worker thread.
+ * - Add task priorities to ThreadPool::add_task() (see TaskPriority), with optional
+ *   starvation protection via ThreadPool::Options::priority_aging.
+ * - Add opt-in runtime metrics to ThreadPool (ThreadPool::Options::collect_metrics and
+ *   ThreadPool::get_metrics()): histograms of queue latency and execution time, counters
+ *   for completed, failed, and canceled tasks, per-thread busy ratios, and the highest
+ *   number of pending tasks.
+ * - Add ThreadPool::try_add_task(), which does not throw if the queue is full, and
+ *   ThreadPool::add_task_wait() and ThreadPool::add_task_wait_for(), which wait for
+ *   space in the queue instead.
+ * - ThreadPool can scale the number of worker threads dynamically between
+ *   ThreadPool::Options::num_threads and ThreadPool::Options::max_num_threads, launching
+ *   threads when the queue latency gets too high and terminating idle ones after a
+ *   keep-alive time.
+ * - Add ThreadPool::Options to pin worker threads to CPUs, to name them, and to set
+ *   their scheduling policy (see ThreadSchedulingPolicy). The CPU of a worker thread can
+ *   be queried with ThreadPool::get_thread_cpu().
+ * - Add StopToken for the cooperative cancellation of running ThreadPool tasks. Tasks
+ *   that take a StopToken can be asked to stop via
+ *   ThreadPool::TaskHandle::request_stop().
+ * - Add gul17/coroutine.h with awaitables for C++20 coroutines: schedule() and
+ *   sleep_for() continue a coroutine on a worker thread of a ThreadPool, and
+ *   `co_await std::move(handle)` waits for a task without blocking a thread.
+ * - ThreadPool only notifies a worker thread about a new task if there is a sleeping
+ *   worker that has not been notified yet. Idle workers can optionally poll for new
+ *   tasks before going to sleep (ThreadPool::Options::spin_time). The metrics count the
+ *   wake-ups that were sent and avoided.
+ * - Add ThreadPool::shutdown() to stop a pool after executing or canceling its pending
+ *   tasks (see ShutdownMode) with an optional timeout, and ThreadPool::wait_idle() to
+ *   wait efficiently until a pool has no more pending or running tasks.
+ * - Add optional task execution tracing to ThreadPool
+ *   (ThreadPool::Options::trace_capacity and ThreadPool::get_trace()).
+ *   ThreadPool::write_chrome_trace() exports the trace in the JSON format understood by
+ *   Perfetto and the Chrome trace viewer.
+ * - Add a micro-benchmark suite for ThreadPool (meson option `benchmarks`, run with
+ *   `meson test --benchmark`). It measures submission throughput, dispatch latency,
+ *   the accuracy of delayed tasks, and the scaling with the number of producer and
+ *   worker threads, and can print its results as JSON lines.
+ * - Add SlidingBufferPow2, a variant of SlidingBuffer with a power-of-two capacity. It
+ *   uses free-running counters and bit masks instead of wrapping indices, so pushing
+ *   and accessing elements does not need any compare-and-wrap branches.
+ * - Add bulk operations to SlidingBuffer and SlidingBufferPow2: push_back() for ranges
+ *   and spans copies the elements in at most two contiguous chunks, pop_front() and
+ *   pop_back() can drop several elements at once, and as_segments() returns the
+ *   contents as (up to) two contiguous spans.
+ * - Add SpscRingBuffer, a lock-free ring buffer with fixed capacity for passing
+ *   elements from one producer thread to one consumer thread, with single-element and
+ *   bulk operations.
+ * - Add MpmcQueue, a bounded lock-free queue for any number of producer and consumer
+ *   threads with non-blocking and blocking push and pop functions. The benchmark suite
+ *   compares it with a mutex-protected SlidingBuffer.
+ * - Add RollingStatistics, which keeps the mean, RMS, standard deviation, minimum, and
+ *   maximum of the last N values up to date with constant cost per inserted value.
  *
  * \subsection V26_5_0 Version 26.5.0
  *
@@ -472,12 +543,28 @@ namespace gul17 {
  *     A thread pool and task queue that allows executing tasks on a fixed number of
  *     worker threads.
  *
+ * \ref gul17::MpmcQueue "MpmcQueue":
+ *     A bounded lock-free queue for passing elements between any number of producer and
+ *     consumer threads.
+ *
+ * \ref gul17::SpscRingBuffer "SpscRingBuffer":
+ *     A lock-free ring buffer for passing elements from one producer thread to one
+ *     consumer thread.
+ *
  * \ref gul17::Trigger "Trigger":
  *     A class that allows sending triggers and waiting for them across different threads,
  *     like an electric trigger line.
  *
  * <h3>Functions</h3>
  *
+ * parallel_for(), parallel_reduce():
+ *     Process a range of indices in parallel on the worker threads of a ThreadPool and
+ *     the calling thread.
+ *
+ * schedule(), sleep_for(), sleep_until():
+ *     Continue a C++20 coroutine on a worker thread of a ThreadPool, optionally after a
+ *     delay (see gul17/coroutine.h).
+ *
  * sleep():
  *     Wait for a given amount of time and be woken up from a different thread.
  */
@@ -545,6 +632,10 @@ namespace gul17 {
  * \ref gul17::MinMax "MinMax":
  *     Holds a pair of two values, typically the minimum and maximum element of something.
  *
+ * \ref gul17::RollingStatistics "RollingStatistics":
+ *     Keeps statistics on the most recent values of a data stream (a sliding window) up
+ *     to date as new values arrive.
+ *
  * \ref gul17::StandardDeviationMean "StandardDeviationMean":
  *     Holds a pair of two values, typically the standard deviation and the mean value of
  *     something.
@@ -733,6 +824,17 @@ namespace gul17 {
  *     The same as SlidingBuffer, but with direct iterator access to the underlying buffer
  *     for maximum performance.
  *
+ * SlidingBufferPow2:
+ *     The same as SlidingBuffer, but restricted to power-of-two capacities for faster
+ *     indexing.
+ *
+ * SpscRingBuffer:
+ *     A lock-free ring buffer of fixed capacity for passing elements from one producer
+ *     thread to one consumer thread.
+ *
+ * MpmcQueue:
+ *     A bounded lock-free queue for any number of producer and consumer threads.
+ *
  * SmallVector:
  *     A resizable container with contiguous storage that can hold a specified number of
  *     elements without allocating memory on the heap.
@@ -0,0 +1,430 @@
+/**
+ * \file  MpmcQueue.h
+ * \date  Created on October 17, 2026
+ * \brief Declaration of the MpmcQueue class for the General Utility Library.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_MPMCQUEUE_H_
+#define GUL17_MPMCQUEUE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gul17/cat.h"
+
+namespace gul17 {
+
+/**
+ * \addtogroup MpmcQueue_h gul17/MpmcQueue.h
+ * \brief A bounded lock-free queue for multiple producer and consumer threads.
+ * @{
+ */
+
+/**
+ * A bounded FIFO queue that can be used concurrently by any number of producer and
+ * consumer threads.
+ *
+ * The queue is based on Dmitry Vyukov's bounded MPMC queue: Each slot of a ring buffer
+ * carries a sequence number that tells producers and consumers whether the slot is free
+ * for writing or holds an element for reading in the current round. Producers and
+ * consumers claim slots by advancing a shared position counter with a compare-and-swap,
+ * so no mutex is involved in try_push() and try_pop().
+ *
+ * \code
+ * MpmcQueue<Event, 1024> queue;
+ *
+ * // Any number of device threads
+ * if (not queue.try_push(event))
+ *     ++num_dropped_events;
+ *
+ * // Any number of worker threads
+ * Event event = queue.pop(); // Blocks until an event is available
+ * \endcode
+ *
+ * The blocking functions push() and pop() wait on a condition variable if the queue is
+ * full or empty, respectively. All functions only touch the mutex of the condition
+ * variables if a thread is actually waiting.
+ *
+ * Like SlidingBuffer, the queue can be instantiated in two versions:
+ * * If the capacity is known at compile time, it can be specified as the
+ *   \b `fixed_capacity` template parameter. The slots are stored within the queue object
+ *   as in a std::array.
+ * * If \b `fixed_capacity` is omitted, the capacity has to be passed to the constructor
+ *   and the slots are allocated dynamically.
+ *
+ * In both cases, the capacity must be a power of two and at least 2. With a single slot,
+ * the sequence numbers that mark it as full and as empty would be the same.
+ *
+ * \code
+ * Member types:
+ *   value_type                  Type of the elements
+ *   size_type                   Unsigned integer type (std::size_t)
+ *
+ * Member functions:
+ *     MpmcQueue         Constructor
+ *   Modifiers:
+ *     try_push          Insert an element at the back if there is space
+ *     push              Insert an element at the back, wait for space if necessary
+ *     try_pop           Remove the foremost element if there is one
+ *     pop               Remove the foremost element, wait for one if necessary
+ *   Capacity:
+ *     size              Return the number of elements (snapshot)
+ *     capacity          Return maximum number of elements
+ *     empty             Check whether the queue is empty (snapshot)
+ * \endcode
+ *
+ * \b `ElementT` must be default constructible and move assignable.
+ *
+ * \tparam ElementT       Type of elements in the queue
+ * \tparam fixed_capacity Maximum number of elements in the queue (a power of two of at
+ *                        least 2), zero if specified at runtime
+ */
+template <typename ElementT, std::size_t fixed_capacity = 0u>
+class MpmcQueue
+{
+    static_assert(fixed_capacity == 0u
+        || (fixed_capacity >= 2u && (fixed_capacity & (fixed_capacity - 1u)) == 0u),
+        "The capacity of an MpmcQueue must be a power of two and at least 2");
+
+public:
+    /// Type of the elements in the queue
+    using value_type = ElementT;
+    /// Unsigned integer type
+    using size_type = std::size_t;
+
+    /**
+     * Construct an empty queue with a capacity of \b `fixed_capacity` elements.
+     *
+     * Only available if the capacity is specified as a template parameter.
+     */
+    MpmcQueue() noexcept
+    {
+        static_assert(fixed_capacity != 0u,
+            "MpmcQueue with runtime capacity must be constructed with a capacity");
+        init_sequences();
+    }
+
+    /**
+     * Construct an empty queue with the given capacity.
+     *
+     * Only available if \b `fixed_capacity` is zero.
+     *
+     * \exception std::invalid_argument is thrown if `capacity` is not a power of two or
+     *            smaller than 2.
+     */
+    explicit MpmcQueue(size_type capacity)
+        : slots_(check_capacity(capacity))
+    {
+        static_assert(fixed_capacity == 0u,
+            "The capacity of this MpmcQueue is already fixed by the template parameter");
+        init_sequences();
+    }
+
+    /**
+     * Insert an element at the back of the queue if it is not full.
+     *
+     * \returns true if the element was inserted, false if the queue was full.
+     */
+    bool try_push(const value_type& in)
+    {
+        if (not try_push_quiet(in))
+            return false;
+
+        notify_waiting(num_waiting_consumers_, data_cv_);
+        return true;
+    }
+
+    /**
+     * \overload
+     */
+    bool try_push(value_type&& in)
+    {
+        if (not try_push_quiet(std::move(in)))
+            return false;
+
+        notify_waiting(num_waiting_consumers_, data_cv_);
+        return true;
+    }
+
+    /**
+     * Insert an element at the back of the queue. If the queue is full, wait until
+     * another thread has removed an element.
+     */
+    void push(value_type in)
+    {
+        if (not try_push_quiet(std::move(in)))
+        {
+            wait_until(num_waiting_producers_, space_cv_,
+                [this, &in]() { return try_push_quiet(std::move(in)); });
+        }
+
+        notify_waiting(num_waiting_consumers_, data_cv_);
+    }
+
+    /**
+     * Remove the foremost element from the queue if it is not empty.
+     *
+     * \param out  Reference to which the removed element is move-assigned
+     * \returns true if an element was removed, false if the queue was empty.
+     */
+    bool try_pop(value_type& out)
+    {
+        if (not try_pop_quiet(out))
+            return false;
+
+        notify_waiting(num_waiting_producers_, space_cv_);
+        return true;
+    }
+
+    /**
+     * Remove the foremost element from the queue and return it. If the queue is empty,
+     * wait until another thread has inserted an element.
+     */
+    value_type pop()
+    {
+        value_type out{};
+
+        if (not try_pop_quiet(out))
+        {
+            wait_until(num_waiting_consumers_, data_cv_,
+                [this, &out]() { return try_pop_quiet(out); });
+        }
+
+        notify_waiting(num_waiting_producers_, space_cv_);
+        return out;
+    }
+
+    /**
+     * Return the number of elements in the queue.
+     *
+     * If called while other threads modify the queue, the result may already be
+     * outdated when the function returns.
+     */
+    size_type size() const noexcept
+    {
+        auto const begin = idx_begin_.load(std::memory_order_acquire);
+        auto const end = idx_end_.load(std::memory_order_acquire);
+        auto const diff = static_cast<std::ptrdiff_t>(end - begin);
+
+        if (diff <= 0)
+            return 0u;
+
+        return std::min(static_cast<size_type>(diff), capacity());
+    }
+
+    /// Return the maximum possible number of elements in the queue.
+    size_type capacity() const noexcept
+    {
+        return (fixed_capacity > 0u) ? fixed_capacity : slots_.size();
+    }
+
+    /**
+     * Check if the queue contains no elements.
+     *
+     * If called while other threads modify the queue, the result may already be
+     * outdated when the function returns.
+     */
+    bool empty() const noexcept
+    {
+        return size() == 0u;
+    }
+
+private:
+    /// A slot for one element with its sequence number.
+    struct Slot
+    {
+        /**
+         * Equal to the position of a producer for which the slot is free, or equal to
+         * the position of a consumer plus one if the slot holds an element for it.
+         */
+        std::atomic<size_type> sequence_{ 0u };
+        value_type value_{};
+    };
+
+    using SlotContainer = std::conditional_t<(fixed_capacity > 0u),
+        std::array<Slot, fixed_capacity>, std::vector<Slot>>;
+
+    /// Position of the next element to be written, claimed by producers.
+    alignas(64) std::atomic<size_type> idx_end_{ 0u };
+    /// Position of the next element to be read, claimed by consumers.
+    alignas(64) std::atomic<size_type> idx_begin_{ 0u };
+
+    /// Number of threads waiting in push() for free space.
+    alignas(64) std::atomic<size_type> num_waiting_producers_{ 0u };
+    /// Number of threads waiting in pop() for an element.
+    std::atomic<size_type> num_waiting_consumers_{ 0u };
+    /// Mutex for the condition variables.
+    std::mutex mutex_;
+    /// Condition variable for threads waiting in push().
+    std::condition_variable space_cv_;
+    /// Condition variable for threads waiting in pop().
+    std::condition_variable data_cv_;
+
+    /// The slots of the ring buffer.
+    SlotContainer slots_{};
+
+    size_type mask() const noexcept
+    {
+        return capacity() - 1u;
+    }
+
+    void init_sequences() noexcept
+    {
+        for (size_type i = 0; i != capacity(); ++i)
+            slots_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+
+    /// Try to claim a slot and move the foremost element out of it, without notifying.
+    bool try_pop_quiet(value_type& out)
+    {
+        size_type pos = idx_begin_.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &slots_[pos & mask()];
+            auto const seq = slot->sequence_.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(seq - (pos + 1u));
+
+            if (diff == 0)
+            {
+                if (idx_begin_.compare_exchange_weak(pos, pos + 1u,
+                        std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Queue is empty
+            }
+            else
+            {
+                pos = idx_begin_.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = std::move(slot->value_);
+        slot->sequence_.store(pos + capacity(), std::memory_order_release);
+        return true;
+    }
+
+    /// Try to claim a free slot and move an element into it, without notifying.
+    template <typename T>
+    bool try_push_quiet(T&& in)
+    {
+        size_type pos = idx_end_.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &slots_[pos & mask()];
+            auto const seq = slot->sequence_.load(std::memory_order_acquire);
+            auto const diff = static_cast<std::ptrdiff_t>(seq - pos);
+
+            if (diff == 0)
+            {
+                if (idx_end_.compare_exchange_weak(pos, pos + 1u,
+                        std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false; // Queue is full
+            }
+            else
+            {
+                pos = idx_end_.load(std::memory_order_relaxed);
+            }
+        }
+
+        slot->value_ = std::forward<T>(in);
+        slot->sequence_.store(pos + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Wake up the threads waiting on the given counter, if any.
+     *
+     * The fence orders the publication of the slot before the check of the counter; the
+     * waiting side announces itself before checking the queue. This way, either the
+     * waiter sees the change or we see the waiter.
+     */
+    void notify_waiting(const std::atomic<size_type>& num_waiting,
+        std::condition_variable& cv)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (num_waiting.load(std::memory_order_relaxed) == 0u)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        cv.notify_one();
+    }
+
+    /**
+     * Announce a waiting thread on the given counter and wait on the condition variable
+     * until pred() succeeds.
+     */
+    template <typename Predicate>
+    void wait_until(std::atomic<size_type>& num_waiting, std::condition_variable& cv,
+        Predicate pred)
+    {
+        num_waiting.fetch_add(1u, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv.wait(lock, pred);
+        }
+
+        num_waiting.fetch_sub(1u, std::memory_order_relaxed);
+    }
+
+    static size_type check_capacity(size_type capacity)
+    {
+        if (capacity < 2u || (capacity & (capacity - 1u)) != 0u)
+        {
+            throw std::invalid_argument(cat("MpmcQueue: Capacity (", capacity,
+                ") is not a power of two of at least 2"));
+        }
+        return capacity;
+    }
+};
+
+/// @}
+
+} // namespace gul17
+
+#endif
+
+// vi:ts=4:sw=4:sts=4:et
@@ -0,0 +1,416 @@
+/**
+ * \file  RollingStatistics.h
+ * \date  Created on October 17, 2026
+ * \brief Declaration of the RollingStatistics class for the General Utility Library.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_ROLLINGSTATISTICS_H_
+#define GUL17_ROLLINGSTATISTICS_H_
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "gul17/SlidingBuffer.h"
+#include "gul17/statistics.h"
+
+namespace gul17 {
+
+/**
+ * \addtogroup RollingStatistics_h gul17/RollingStatistics.h
+ * \brief Statistics over a sliding window of values.
+ * @{
+ */
+
+/**
+ * A sliding window of numeric values that keeps its statistics up to date
+ * incrementally.
+ *
+ * RollingStatistics wraps a SlidingBuffer. Whenever a value is added with push_back()
+ * and the window is full, the oldest value drops out, just like with
+ * SlidingBuffer::push_back(). Instead of recalculating mean(), rms(),
+ * standard_deviation(), minimum(), and maximum() over the whole window every time,
+ * these statistics are updated with each new value in O(1) (amortized):
+ *
+ * * Mean and variance are maintained with Welford's algorithm, extended for the removal
+ *   of values.
+ * * The sum of squares for the rms value uses compensated (Kahan-Neumaier) summation.
+ * * Minimum and maximum are tracked with monotonic queues of candidate values.
+ *
+ * \code
+ * RollingStatistics<double, 1000> stats;
+ *
+ * for (auto sample : samples)
+ * {
+ *     stats.push_back(sample);
+ *     std::cout << stats.mean() << " +- " << stats.standard_deviation().sigma() << "\n";
+ * }
+ * \endcode
+ *
+ * The results agree with those of the corresponding functions from statistics.h applied
+ * to buffer(), up to rounding errors. Because the incremental updates can accumulate
+ * rounding errors over a very long time, recalculate() is provided to recompute the
+ * accumulators from the window contents.
+ *
+ * As with the functions from statistics.h, a not-a-number value in the window makes
+ * mean(), rms(), and standard_deviation() return NaN, while minimum() and maximum()
+ * ignore it. Once the NaN has left the window, all statistics are valid again.
+ *
+ * \tparam ElementT       Arithmetic type of the values
+ * \tparam fixed_capacity Size of the window, zero if specified at runtime
+ */
+template <typename ElementT, std::size_t fixed_capacity = 0u>
+class RollingStatistics
+{
+    static_assert(std::is_arithmetic<ElementT>::value,
+        "RollingStatistics requires an arithmetic element type");
+
+public:
+    /// Type of the values
+    using value_type = ElementT;
+    /// Unsigned integer type
+    using size_type = std::size_t;
+    /// Type of the statistical results
+    using result_type = statistics_result_type;
+    /// Type of the underlying SlidingBuffer
+    using buffer_type = SlidingBuffer<ElementT, fixed_capacity>;
+
+    /**
+     * Construct an empty window.
+     *
+     * If \b `fixed_capacity` is zero, the window has a size of zero and the
+     * \ref RollingStatistics(size_type) constructor should be used instead.
+     */
+    RollingStatistics() = default;
+
+    /**
+     * \overload
+     *
+     * Only available if \b `fixed_capacity` is zero. Constructs a window for the given
+     * number of values.
+     */
+    explicit RollingStatistics(size_type capacity)
+        : buffer_(capacity)
+        , min_candidates_(capacity)
+        , max_candidates_(capacity)
+    {}
+
+    /**
+     * Add a value to the window. If the window is full, the oldest value is dropped.
+     *
+     * \warning
+     * Calling push_back() on a window with zero capacity results in undefined behavior.
+     */
+    void push_back(value_type value)
+    {
+        if (buffer_.filled())
+            remove_value(buffer_.front());
+
+        buffer_.push_back(value);
+        add_value(value);
+        add_extreme_candidate(value);
+    }
+
+    /// Remove all values from the window.
+    void clear()
+    {
+        buffer_.clear();
+        min_candidates_.clear();
+        max_candidates_.clear();
+        reset_accumulators();
+        next_seq_ = 0u;
+    }
+
+    /**
+     * Recalculate the sum, mean, and variance from the values in the window.
+     *
+     * This is an O(capacity) operation that removes the rounding errors which the
+     * incremental updates may accumulate over a very large number of values.
+     */
+    void recalculate()
+    {
+        reset_accumulators();
+        for (auto const value : buffer_)
+            add_value(value);
+    }
+
+    /// Return the underlying SlidingBuffer with the values in the window.
+    const buffer_type& buffer() const noexcept
+    {
+        return buffer_;
+    }
+
+    /// Return the number of values in the window.
+    size_type size() const noexcept
+    {
+        return buffer_.size();
+    }
+
+    /// Return the maximum number of values in the window.
+    size_type capacity() const noexcept
+    {
+        return buffer_.capacity();
+    }
+
+    /// Check if the window contains no values.
+    bool empty() const noexcept
+    {
+        return buffer_.empty();
+    }
+
+    /// Check if the window is completely filled with values.
+    bool filled() const noexcept
+    {
+        return buffer_.filled();
+    }
+
+    /**
+     * Return the sum of the values in the window.
+     *
+     * This is zero for an empty window and NaN if the window contains a NaN value.
+     */
+    result_type sum() const noexcept
+    {
+        if (num_nan_ != 0u)
+            return std::numeric_limits<result_type>::quiet_NaN();
+
+        return mean_ * static_cast<result_type>(num_);
+    }
+
+    /**
+     * Return the arithmetic mean of the values in the window.
+     *
+     * \see gul17::mean()
+     */
+    result_type mean() const noexcept
+    {
+        if (num_nan_ != 0u or num_ == 0u)
+            return std::numeric_limits<result_type>::quiet_NaN();
+
+        return mean_;
+    }
+
+    /**
+     * Return the root-mean-square value of the values in the window.
+     *
+     * \see gul17::rms()
+     */
+    result_type rms() const noexcept
+    {
+        if (num_nan_ != 0u or num_ == 0u)
+            return std::numeric_limits<result_type>::quiet_NaN();
+
+        auto const sum_sq = sum_sq_ + sum_sq_compensation_;
+        return std::sqrt((sum_sq > 0) ? sum_sq / static_cast<result_type>(num_) : 0);
+    }
+
+    /**
+     * Return the corrected sample standard deviation and the mean of the values in the
+     * window.
+     *
+     * As with gul17::standard_deviation(), both values are NaN for an empty window, and
+     * the standard deviation is NaN for a window with a single value.
+     */
+    StandardDeviationMean<result_type> standard_deviation() const noexcept
+    {
+        if (num_nan_ != 0u or num_ == 0u)
+            return { };
+
+        if (num_ == 1u)
+            return { std::numeric_limits<result_type>::quiet_NaN(), mean_ };
+
+        auto const variance = m2_ / static_cast<result_type>(num_ - 1u);
+        return { std::sqrt(variance > 0 ? variance : 0), mean_ };
+    }
+
+    /**
+     * Return the smallest value in the window.
+     *
+     * NaN values are ignored. If there is no other value, NaN (if supported by the type)
+     * or std::numeric_limits<ElementT>::max() is returned, as with gul17::minimum().
+     */
+    value_type minimum() const noexcept
+    {
+        if (min_candidates_.empty())
+            return MinMax<value_type>{}.min;
+
+        return min_candidates_.front().value_;
+    }
+
+    /**
+     * Return the largest value in the window.
+     *
+     * NaN values are ignored. If there is no other value, NaN (if supported by the type)
+     * or std::numeric_limits<ElementT>::lowest() is returned, as with gul17::maximum().
+     */
+    value_type maximum() const noexcept
+    {
+        if (max_candidates_.empty())
+            return MinMax<value_type>{}.max;
+
+        return max_candidates_.front().value_;
+    }
+
+    /// Return the smallest and the largest value in the window.
+    MinMax<value_type> min_max() const noexcept
+    {
+        MinMax<value_type> result;
+        result.min = minimum();
+        result.max = maximum();
+        return result;
+    }
+
+private:
+    /// A value that may become the minimum or maximum, with its position in the stream.
+    struct Candidate
+    {
+        size_type seq_{ 0u };
+        value_type value_{ };
+    };
+
+    using CandidateBuffer = SlidingBuffer<Candidate, fixed_capacity>;
+
+    /// The values in the window.
+    buffer_type buffer_;
+    /// Ascending values that can still become the minimum, oldest at the front.
+    CandidateBuffer min_candidates_;
+    /// Descending values that can still become the maximum, oldest at the front.
+    CandidateBuffer max_candidates_;
+    /// Position of the next value in the stream of all values pushed.
+    size_type next_seq_{ 0u };
+
+    /// Number of non-NaN values in the window.
+    size_type num_{ 0u };
+    /// Number of NaN values in the window.
+    size_type num_nan_{ 0u };
+    /// Mean of the non-NaN values.
+    result_type mean_{ 0 };
+    /// Sum of squared differences from the mean (Welford).
+    result_type m2_{ 0 };
+    /// Sum of squares of the non-NaN values.
+    result_type sum_sq_{ 0 };
+    /// Compensation for the lost low-order bits of sum_sq_.
+    result_type sum_sq_compensation_{ 0 };
+
+    static bool is_nan(value_type value) noexcept
+    {
+        return not (value == value);
+    }
+
+    void reset_accumulators() noexcept
+    {
+        num_ = 0u;
+        num_nan_ = 0u;
+        mean_ = 0;
+        m2_ = 0;
+        sum_sq_ = 0;
+        sum_sq_compensation_ = 0;
+    }
+
+    void add_value(value_type value) noexcept
+    {
+        if (is_nan(value)) {
+            ++num_nan_;
+            return;
+        }
+
+        auto const x = static_cast<result_type>(value);
+        ++num_;
+        auto const delta = x - mean_;
+        mean_ += delta / static_cast<result_type>(num_);
+        m2_ += delta * (x - mean_);
+        add_to_sum_sq(x * x);
+    }
+
+    void remove_value(value_type value) noexcept
+    {
+        if (is_nan(value)) {
+            --num_nan_;
+            return;
+        }
+
+        --num_;
+        if (num_ == 0u) {
+            auto const num_nan = num_nan_;
+            reset_accumulators();
+            num_nan_ = num_nan;
+            return;
+        }
+
+        auto const x = static_cast<result_type>(value);
+        auto const delta = x - mean_;
+        mean_ -= delta / static_cast<result_type>(num_);
+        m2_ -= delta * (x - mean_);
+        add_to_sum_sq(-x * x);
+    }
+
+    /// Add a term to the sum of squares with Neumaier's compensated summation.
+    void add_to_sum_sq(result_type term) noexcept
+    {
+        auto const new_sum = sum_sq_ + term;
+
+        if (std::abs(sum_sq_) >= std::abs(term))
+            sum_sq_compensation_ += (sum_sq_ - new_sum) + term;
+        else
+            sum_sq_compensation_ += (term - new_sum) + sum_sq_;
+
+        sum_sq_ = new_sum;
+    }
+
+    /**
+     * Update the monotonic candidate queues for a value that has just been added:
+     * Drop the candidate that left the window, then all candidates that can never
+     * become the minimum (maximum) again because the new value is smaller (larger) and
+     * stays in the window longer.
+     */
+    void add_extreme_candidate(value_type value)
+    {
+        auto const seq = next_seq_++;
+        auto const first_seq_in_window = next_seq_ - buffer_.size();
+
+        for (auto* candidates : { &min_candidates_, &max_candidates_ })
+        {
+            if (not candidates->empty() and candidates->front().seq_ < first_seq_in_window)
+                candidates->pop_front();
+        }
+
+        if (is_nan(value))
+            return;
+
+        while (not min_candidates_.empty() and not (min_candidates_.back().value_ < value))
+            min_candidates_.pop_back();
+        min_candidates_.push_back(Candidate{ seq, value });
+
+        while (not max_candidates_.empty() and not (max_candidates_.back().value_ > value))
+            max_candidates_.pop_back();
+        max_candidates_.push_back(Candidate{ seq, value });
+    }
+};
+
+/// @}
+
+} // namespace gul17
+
+#endif
+
+// vi:ts=4:sw=4:sts=4:et
@@ -28,11 +28,16 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
 #include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "gul17/cat.h"
 #include "gul17/internal.h"
+#include "gul17/span.h"
 
 namespace gul17 {
 
@@ -110,7 +115,7 @@ enum class ShrinkBehavior { keep_front_elements, keep_back_elements };
  *
  * This container uses an accompanying iterator class called SlidingBufferIterator.
  * See SlidingBufferExposed for a variant with a different (more performant) iterator
- * interface.
+ * interface and SlidingBufferPow2 for a faster variant with a power-of-two capacity.
  *
  * Iterator invalidation is specified at SlidingBufferIterator.
  *
@@ -132,12 +137,13 @@ enum class ShrinkBehavior { keep_front_elements, keep_back_elements };
  * Member functions:
  *     SlidingBuffer     Constructor
  *   Element access:
- *     push_back         Insert an element at the back of the buffer
+ *     push_back         Insert an element or a range of elements at the back of the buffer
  *     push_front        Insert an element at the front of the buffer
  *     operator[]        Access element by index, unchecked
  *     at                Access element by index with bounds checking
  *     front             Access the foremost element (i.e. [0])
  *     back              Access the last element (i.e. [size() - 1])
+ *     as_segments       Return the elements as (up to) two contiguous spans
  *   Iterators:
  *     begin, cbegin     Return an iterator to the first element of the container
  *     end, cend         Return an iterator to the element following the last element of the container
@@ -152,8 +158,8 @@ enum class ShrinkBehavior { keep_front_elements, keep_back_elements };
  *     reserve           Change the maximum number of elements (only if fixed_size==0)
  *   Modifiers:
  *     clear             Empty the buffer
- *     pop_back          Drop the last element
- *     pop_front         Drop the foremost element
+ *     pop_back          Drop the last element(s)
+ *     pop_front         Drop the foremost element(s)
  *
  * Non-member functions:
  *   operator<<          Dump the raw data of the buffer to an ostream
@@ -276,6 +282,22 @@ public:
         full_ = false;
     }
 
+    /**
+     * Remove the given number of elements from the back of the buffer.
+     *
+     * \warning
+     * Calling pop_back() with a `count` greater than size() results in undefined
+     * behavior.
+     */
+    auto pop_back(size_type count) -> void
+    {
+        if (count == 0)
+            return;
+
+        idx_end_ = (idx_end_ >= count) ? idx_end_ - count : idx_end_ + capacity() - count;
+        full_ = false;
+    }
+
     /**
      * Remove the first element from the buffer.
      *
@@ -293,6 +315,27 @@ public:
         full_ = false;
     }
 
+    /**
+     * Remove the given number of elements from the front of the buffer.
+     *
+     * Together with as_segments(), this allows a consumer to process and discard a block
+     * of elements at once.
+     *
+     * \warning
+     * Calling pop_front() with a `count` greater than size() results in undefined
+     * behavior.
+     */
+    auto pop_front(size_type count) -> void
+    {
+        if (count == 0)
+            return;
+
+        idx_begin_ += count;
+        if (idx_begin_ >= capacity())
+            idx_begin_ -= capacity();
+        full_ = false;
+    }
+
     /**
      * Insert one element at the end of the buffer; if it is full, an element at the front
      * is dropped to make room.
@@ -331,6 +374,72 @@ public:
             full_ = true;
     }
 
+    /**
+     * Insert a range of elements at the end of the buffer; if it gets full, elements at
+     * the front are dropped to make room.
+     *
+     * The result is the same as if push_back() had been called for each element of the
+     * range. For forward iterators, however, the elements are copied into the underlying
+     * container in at most two contiguous chunks. If the range contains more elements
+     * than the capacity, only the last capacity() elements are copied.
+     *
+     * \code
+     * SlidingBuffer<int, 4> buf;
+     * std::vector<int> block{ 1, 2, 3, 4, 5, 6 };
+     * buf.push_back(block.begin(), block.end()); // buf contains 3, 4, 5, 6
+     * \endcode
+     */
+    template <typename InputIt>
+    auto push_back(InputIt first, InputIt last) -> void
+    {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (not std::is_base_of<std::forward_iterator_tag, Category>::value)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+        else
+        {
+            auto const num = static_cast<size_type>(std::distance(first, last));
+            auto const cap = capacity();
+
+            if (num >= cap) {
+                std::advance(first, static_cast<difference_type>(num - cap));
+                std::copy(first, last, storage_.begin());
+                idx_begin_ = 0u;
+                idx_end_ = 0u;
+                full_ = (cap != 0u);
+                return;
+            }
+
+            auto const old_size = size();
+            auto const mid = std::next(first,
+                static_cast<difference_type>(std::min(num, cap - idx_end_)));
+
+            std::copy(first, mid,
+                storage_.begin() + static_cast<difference_type>(idx_end_));
+            std::copy(mid, last, storage_.begin());
+
+            idx_end_ += num;
+            if (idx_end_ >= cap)
+                idx_end_ -= cap;
+
+            if (old_size + num >= cap) {
+                idx_begin_ = idx_end_;
+                full_ = true;
+            }
+        }
+    }
+
+    /**
+     * \overload
+     */
+    auto push_back(span<const value_type> values) -> void
+    {
+        push_back(values.begin(), values.end());
+    }
+
     /**
      * Insert one element at the front of the buffer; if it is full, an element at the
      * back is dropped to make room.
@@ -476,6 +585,37 @@ public:
             return storage_[idx_end_ - 1];
     }
 
+    /**
+     * Return the elements of the buffer as two contiguous spans of the underlying
+     * container.
+     *
+     * The first span starts with front(), the second one continues where the first one
+     * ends and finishes with back(). If the elements are stored contiguously, the second
+     * span is empty. This allows to run algorithms on the data (e.g. vectorized numeric
+     * kernels) without going through the iterators of the buffer:
+     *
+     * \code
+     * auto [seg1, seg2] = buf.as_segments();
+     * auto sum = std::accumulate(seg1.begin(), seg1.end(), 0.0);
+     * sum = std::accumulate(seg2.begin(), seg2.end(), sum);
+     * \endcode
+     *
+     * The spans are invalidated by any modification of the buffer.
+     */
+    auto as_segments() noexcept -> std::pair<span<value_type>, span<value_type>>
+    {
+        return get_segments(storage_.data());
+    }
+
+    /**
+     * \overload
+     */
+    auto as_segments() const noexcept
+        -> std::pair<span<const value_type>, span<const value_type>>
+    {
+        return get_segments(storage_.data());
+    }
+
     /**
      * Return the number of elements in the container, i.e. std::distance(begin(), end()).
      *
@@ -941,6 +1081,20 @@ public:
     }
 
 private:
+    template <typename Pointer>
+    auto get_segments(Pointer data) const noexcept
+        -> std::pair<span<std::remove_pointer_t<Pointer>>,
+                     span<std::remove_pointer_t<Pointer>>>
+    {
+        if (empty())
+            return {};
+
+        if (idx_end_ > idx_begin_)
+            return { { data + idx_begin_, idx_end_ - idx_begin_ }, {} };
+
+        return { { data + idx_begin_, capacity() - idx_begin_ }, { data, idx_end_ } };
+    }
+
     void decrease_idx(size_t &idx) noexcept
     {
         if (idx == 0)
@@ -1318,6 +1472,588 @@ public:
     }
 };
 
+/**
+ * A variant of SlidingBuffer whose capacity must be a power of two.
+ *
+ * SlidingBufferPow2 offers the same interface as SlidingBuffer, but it uses a
+ * different internal representation that is faster for high-rate data streams: Instead
+ * of wrapping indices into the underlying container, it keeps two monotonically
+ * increasing counters for the front and the back of the buffer. The position of an
+ * element in the container is found by masking the counter with `capacity() - 1`, and
+ * the size is simply the difference of the counters. Neither push_back() nor
+ * push_front() nor operator[] need any compare-and-wrap branches or a flag for the
+ * filled state.
+ *
+ * \code
+ * SlidingBufferPow2<double, 1024> buf; // Capacity must be a power of two
+ *
+ * for (int i = 0; i != 2000; ++i)
+ *     buf.push_back(i);
+ *
+ * std::cout << buf.front() << ", " << buf.back() << "\n";
+ * // prints "976, 1999"
+ * \endcode
+ *
+ * The iterators of this class are \ref SlidingBuffer::SlidingBufferIterator
+ * "SlidingBufferIterator"s with the same invalidation rules as for SlidingBuffer.
+ *
+ * \code
+ * Member functions:
+ *     SlidingBufferPow2 Constructor
+ *   Element access:
+ *     push_back         Insert an element or a range of elements at the back of the buffer
+ *     push_front        Insert an element at the front of the buffer
+ *     operator[]        Access element by index, unchecked
+ *     at                Access element by index with bounds checking
+ *     front             Access the foremost element (i.e. [0])
+ *     back              Access the last element (i.e. [size() - 1])
+ *     as_segments       Return the elements as (up to) two contiguous spans
+ *   Iterators:
+ *     begin, cbegin     Return an iterator to the first element of the container
+ *     end, cend         Return an iterator to the element following the last element of the container
+ *     rbegin, crbegin   Return an iterator to the first element of the reversed container
+ *     rend, crend       Return an iterator to the element following the last element of the reversed container
+ *   Capacity:
+ *     size              Return number of used elements
+ *     capacity          Return maximum number of elements
+ *     filled            Check whether the buffer is completely filled
+ *     empty             Check whether the buffer is empty
+ *     resize            Change the maximum number of elements (only if fixed_size==0)
+ *     reserve           Change the maximum number of elements (only if fixed_size==0)
+ *   Modifiers:
+ *     clear             Empty the buffer
+ *     pop_back          Drop the last element(s)
+ *     pop_front         Drop the foremost element(s)
+ *
+ * Non-member functions:
+ *   operator<<          Dump the raw data of the buffer to an ostream
+ * \endcode
+ *
+ * \b `ElementT` must be default constructible.
+ *
+ * \tparam ElementT       Type of elements in the buffer
+ * \tparam fixed_capacity Maximum number of elements in the buffer (capacity), zero if
+ *                        unspecified/dynamic. Must be a power of two otherwise.
+ * \tparam Container      Type of the underlying container, usually not specified
+ */
+template<typename ElementT, std::size_t fixed_capacity = 0u,
+    typename Container = typename std::conditional_t<(fixed_capacity >= 1u),
+        std::array<ElementT, fixed_capacity>,
+        std::vector<ElementT>>
+    >
+class SlidingBufferPow2 {
+    static_assert((fixed_capacity & (fixed_capacity - 1u)) == 0u,
+        "The capacity of a SlidingBufferPow2 must be a power of two");
+
+public:
+    /// Type of the underlying container (e.g. std::array<value_type, ..>)
+    using container_type = Container;
+    /// Type of the elements in the underlying container
+    using value_type = ElementT;
+    /// Unsigned integer type (usually std::size_t)
+    using size_type = typename Container::size_type;
+    /// Signed integer type (usually std::ptrdiff_t)
+    using difference_type = typename Container::difference_type;
+    /// Reference to an element
+    using reference = typename Container::reference;
+    /// Reference to a constant element
+    using const_reference = typename Container::const_reference;
+    /// Pointer to an element
+    using pointer = typename Container::pointer;
+    /// Pointer to a constant element
+    using const_pointer = typename Container::const_pointer;
+    /// Iterator to an element
+    using iterator = typename SlidingBuffer<ElementT, fixed_capacity, Container>::
+        template SlidingBufferIterator<SlidingBufferPow2*>;
+    /// Iterator to a const element
+    using const_iterator = typename SlidingBuffer<ElementT, fixed_capacity, Container>::
+        template SlidingBufferIterator<SlidingBufferPow2 const*>;
+    /// Iterator to an element in reversed container
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    /// Iterator to a const element in reversed container
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    /**
+     * Construct an empty sliding buffer.
+     *
+     * If the \b `fixed_capacity` template argument is not zero, a std::array based
+     * buffer with that (unchangeable) capacity is created. Otherwise, the buffer is based
+     * on std::vector and has a capacity of zero elements until resize() is called.
+     */
+    SlidingBufferPow2() = default;
+
+    /**
+     * \overload
+     *
+     * Only available for sliding buffers based on std::vector.
+     *
+     * Constructs a sliding buffer with a specified capacity.
+     *
+     * \exception std::invalid_argument is thrown if `count` is not zero and not a power
+     *            of two.
+     */
+    explicit SlidingBufferPow2(size_type count)
+        : storage_(check_capacity(count))
+    {}
+
+    /**
+     * Remove the last element from the buffer.
+     *
+     * \warning
+     * Calling pop_back() on an empty buffer results in undefined behavior.
+     */
+    auto pop_back() noexcept -> void
+    {
+        --idx_end_;
+    }
+
+    /**
+     * Remove the given number of elements from the back of the buffer.
+     *
+     * \warning
+     * Calling pop_back() with a `count` greater than size() results in undefined
+     * behavior.
+     */
+    auto pop_back(size_type count) noexcept -> void
+    {
+        idx_end_ -= count;
+    }
+
+    /**
+     * Remove the first element from the buffer.
+     *
+     * \warning
+     * Calling pop_front() on an empty buffer results in undefined behavior.
+     */
+    auto pop_front() noexcept -> void
+    {
+        ++idx_begin_;
+    }
+
+    /**
+     * Remove the given number of elements from the front of the buffer.
+     *
+     * \warning
+     * Calling pop_front() with a `count` greater than size() results in undefined
+     * behavior.
+     */
+    auto pop_front(size_type count) noexcept -> void
+    {
+        idx_begin_ += count;
+    }
+
+    /**
+     * Insert one element at the end of the buffer; if it is full, an element at the front
+     * is dropped to make room.
+     *
+     * \warning
+     * Calling push_back() on a buffer with zero capacity results in undefined behavior.
+     */
+    auto push_back(const value_type& in) -> void
+    {
+        storage_[idx_end_ & mask()] = in;
+        advance_back();
+    }
+
+    /**
+     * \overload
+     */
+    auto push_back(value_type&& in) -> void
+    {
+        storage_[idx_end_ & mask()] = std::move(in);
+        advance_back();
+    }
+
+    /**
+     * Insert a range of elements at the end of the buffer; if it gets full, elements at
+     * the front are dropped to make room.
+     *
+     * For forward iterators, the elements are copied in at most two contiguous chunks.
+     * \see SlidingBuffer::push_back(InputIt, InputIt)
+     */
+    template <typename InputIt>
+    auto push_back(InputIt first, InputIt last) -> void
+    {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (not std::is_base_of<std::forward_iterator_tag, Category>::value)
+        {
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+        else
+        {
+            auto const num = static_cast<size_type>(std::distance(first, last));
+            auto const cap = capacity();
+
+            if (num >= cap) {
+                std::advance(first, static_cast<difference_type>(num - cap));
+                std::copy(first, last, storage_.begin());
+                idx_begin_ = 0u;
+                idx_end_ = cap;
+                return;
+            }
+
+            auto const pos = idx_end_ & mask();
+            auto const mid = std::next(first,
+                static_cast<difference_type>(std::min(num, cap - pos)));
+
+            std::copy(first, mid, storage_.begin() + static_cast<difference_type>(pos));
+            std::copy(mid, last, storage_.begin());
+
+            idx_end_ += num;
+            if (idx_end_ - idx_begin_ > cap)
+                idx_begin_ = idx_end_ - cap;
+        }
+    }
+
+    /**
+     * \overload
+     */
+    auto push_back(span<const value_type> values) -> void
+    {
+        push_back(values.begin(), values.end());
+    }
+
+    /**
+     * Insert one element at the front of the buffer; if it is full, an element at the
+     * back is dropped to make room.
+     *
+     * \warning
+     * Calling push_front() on a buffer with zero capacity results in undefined behavior.
+     */
+    auto push_front(const value_type& in) -> void
+    {
+        advance_front();
+        storage_[idx_begin_ & mask()] = in;
+    }
+
+    /**
+     * \overload
+     */
+    auto push_front(value_type&& in) -> void
+    {
+        advance_front();
+        storage_[idx_begin_ & mask()] = std::move(in);
+    }
+
+    /**
+     * Access an element in the buffer by index without bounds checking.
+     *
+     * Index 0 is the foremost element, `size() - 1` the backmost one. Access to elements
+     * inside the capacity is always allowed; the result for `idx >= size()` is an
+     * unspecified element of the underlying container.
+     */
+    auto operator[](size_type idx) noexcept -> reference
+    {
+        return storage_[(idx_begin_ + idx) & mask()];
+    }
+
+    /**
+     * \overload
+     */
+    auto operator[](size_type idx) const noexcept -> const_reference
+    {
+        return storage_[(idx_begin_ + idx) & mask()];
+    }
+
+    /**
+     * Access an element in the buffer by index with bounds checking.
+     *
+     * \exception std::out_of_range is thrown if `idx >= size()`.
+     */
+    auto at(const size_type idx) -> reference
+    {
+        check_index(idx);
+        return operator[](idx);
+    }
+
+    /**
+     * \overload
+     */
+    auto at(const size_type idx) const -> const_reference
+    {
+        check_index(idx);
+        return operator[](idx);
+    }
+
+    /// Return the foremost element (the one with index 0).
+    auto front() noexcept -> reference
+    {
+        return storage_[idx_begin_ & mask()];
+    }
+
+    /**
+     * \overload
+     */
+    auto front() const noexcept -> const_reference
+    {
+        return storage_[idx_begin_ & mask()];
+    }
+
+    /// Return the backmost element (the one with the highest valid index).
+    auto back() noexcept -> reference
+    {
+        return storage_[(idx_end_ - 1u) & mask()];
+    }
+
+    /**
+     * \overload
+     */
+    auto back() const noexcept -> const_reference
+    {
+        return storage_[(idx_end_ - 1u) & mask()];
+    }
+
+    /**
+     * Return the elements of the buffer as two contiguous spans of the underlying
+     * container.
+     *
+     * \see SlidingBuffer::as_segments()
+     */
+    auto as_segments() noexcept -> std::pair<span<value_type>, span<value_type>>
+    {
+        return get_segments(storage_.data());
+    }
+
+    /**
+     * \overload
+     */
+    auto as_segments() const noexcept
+        -> std::pair<span<const value_type>, span<const value_type>>
+    {
+        return get_segments(storage_.data());
+    }
+
+    /// Return the number of elements in the container.
+    auto size() const noexcept -> size_type
+    {
+        return idx_end_ - idx_begin_;
+    }
+
+    /// Return the maximum possible number of elements in the container.
+    auto constexpr capacity() const noexcept -> size_type
+    {
+        return (fixed_capacity > 0) ? fixed_capacity : storage_.size();
+    }
+
+    /**
+     * Return true if the buffer is completely filled with elements.
+     *
+     * If the buffer has zero capacity the value of filled() is false.
+     */
+    auto filled() const noexcept -> bool
+    {
+        return size() == capacity() and capacity() != 0;
+    }
+
+    /// Check if the buffer contains no elements.
+    auto empty() const noexcept -> bool
+    {
+        return idx_begin_ == idx_end_;
+    }
+
+    /**
+     * Empty the buffer.
+     *
+     * All elements of the underlying container are replaced by default-constructed ones.
+     */
+    auto clear() -> void
+    {
+        idx_begin_ = 0u;
+        idx_end_ = 0u;
+        std::fill(storage_.begin(), storage_.end(), value_type{});
+    }
+
+    /**
+     * Resize the container.
+     *
+     * Only possible if the underlying container is a std::vector.
+     *
+     * * Shrinking: The excess elements are dropped according to \b `shrink_behavior`.
+     * * Growing: The capacity changes, but the (used) size does not.
+     *
+     * \param new_capacity     New capacity (maximum size) of the sliding buffer; must be
+     *                         zero or a power of two.
+     * \param shrink_behavior  Specify the \ref ShrinkBehavior.
+     *
+     * \exception std::invalid_argument is thrown if `new_capacity` is not zero and not a
+     *            power of two.
+     */
+    auto resize(size_type new_capacity,
+        ShrinkBehavior shrink_behavior = ShrinkBehavior::keep_front_elements) -> void
+    {
+        static_assert(fixed_capacity == 0u,
+            "resize() only possible if the underlying container is resizable");
+
+        if (check_capacity(new_capacity) == capacity())
+            return;
+
+        auto const new_size = std::min(size(), new_capacity);
+        auto const first = (shrink_behavior == ShrinkBehavior::keep_back_elements)
+            ? size() - new_size : size_type{ 0 };
+
+        Container new_storage(new_capacity);
+        for (size_type i = 0; i != new_size; ++i)
+            new_storage[i] = std::move(operator[](first + i));
+
+        storage_.swap(new_storage);
+        idx_begin_ = 0u;
+        idx_end_ = new_size;
+    }
+
+    /**
+     * Resize the container (identical to resize()).
+     * \see resize()
+     */
+    auto reserve(size_type size,
+        ShrinkBehavior shrink_behavior = ShrinkBehavior::keep_front_elements) -> void
+    {
+        resize(size, shrink_behavior);
+    }
+
+    /**
+     * Dump all buffer elements.
+     *
+     * Shown on the left is front(), on the right back().
+     */
+    auto friend operator<< (std::ostream& s, const SlidingBufferPow2& buffer)
+        -> std::ostream&
+    {
+        auto const size = buffer.size();
+        for (auto i = size_type{ 0 }; i < size; ++i)
+            s << buffer[i] << "  ";
+        return s << '\n';
+    }
+
+    /// Return an iterator to the first element of the container.
+    auto begin() noexcept -> iterator
+    {
+        return iterator{ this, 0 };
+    }
+
+    /// \overload
+    auto begin() const noexcept -> const_iterator
+    {
+        return const_iterator{ this, 0 };
+    }
+
+    /// Return an iterator to the element following the last element of the container.
+    auto end() noexcept -> iterator
+    {
+        return iterator{ this, size() };
+    }
+
+    /// \overload
+    auto end() const noexcept -> const_iterator
+    {
+        return const_iterator{ this, size() };
+    }
+
+    /// Return a read-only iterator to the first element of the container.
+    auto cbegin() const noexcept -> const_iterator
+    {
+        return const_iterator{ this, 0 };
+    }
+
+    /**
+     * Return a read-only iterator to the element following the last element of the
+     * container.
+     */
+    auto cend() const noexcept -> const_iterator
+    {
+        return const_iterator{ this, size() };
+    }
+
+    /// Return an iterator to the first element of the reversed container.
+    auto rbegin() noexcept -> reverse_iterator
+    {
+        return std::make_reverse_iterator(end());
+    }
+
+    /**
+     * Return an iterator to the element following the last element of the reversed
+     * container.
+     */
+    auto rend() noexcept -> reverse_iterator
+    {
+        return std::make_reverse_iterator(begin());
+    }
+
+    /// Return a read-only iterator to the first element of the reversed container.
+    auto crbegin() const noexcept -> const_reverse_iterator
+    {
+        return std::make_reverse_iterator(cend());
+    }
+
+    /**
+     * Return a read-only iterator to the element following the last element of the
+     * reversed container.
+     */
+    auto crend() const noexcept -> const_reverse_iterator
+    {
+        return std::make_reverse_iterator(cbegin());
+    }
+
+private:
+    /// Counter for the front of the buffer; only the lower bits address the container.
+    size_type idx_begin_{ 0u };
+    /// Counter for the back of the buffer; `idx_end_ - idx_begin_` is the size.
+    size_type idx_end_{ 0u };
+    /// Actual data is stored here, the underlying container.
+    Container storage_{ };
+
+    /// Return the bit mask that maps a counter to an index into the container.
+    auto constexpr mask() const noexcept -> size_type
+    {
+        return capacity() - 1u;
+    }
+
+    template <typename Pointer>
+    auto get_segments(Pointer data) const noexcept
+        -> std::pair<span<std::remove_pointer_t<Pointer>>,
+                     span<std::remove_pointer_t<Pointer>>>
+    {
+        auto const begin = idx_begin_ & mask();
+        auto const num = size();
+        auto const num_first = std::min(num, capacity() - begin);
+
+        return { { data + begin, num_first }, { data, num - num_first } };
+    }
+
+    /// Count a new element at the back, dropping one at the front if necessary.
+    void advance_back() noexcept
+    {
+        ++idx_end_;
+        idx_begin_ += static_cast<size_type>(idx_end_ - idx_begin_ > capacity());
+    }
+
+    /// Count a new element at the front, dropping one at the back if necessary.
+    void advance_front() noexcept
+    {
+        --idx_begin_;
+        idx_end_ -= static_cast<size_type>(idx_end_ - idx_begin_ > capacity());
+    }
+
+    void check_index(size_type idx) const
+    {
+        auto const s = size();
+        if (idx >= s) {
+            throw std::out_of_range(gul17::cat("SlidingBufferPow2: idx (which is ", idx,
+                ") >= this->size() (which is ", s, ")"));
+        }
+    }
+
+    static size_type check_capacity(size_type capacity)
+    {
+        if ((capacity & (capacity - 1u)) != 0u) {
+            throw std::invalid_argument(gul17::cat("SlidingBufferPow2: Capacity (",
+                capacity, ") is not a power of two"));
+        }
+        return capacity;
+    }
+};
+
 /// @}
 
 } // namespace gul17
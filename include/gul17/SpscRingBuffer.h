@@ -0,0 +1,303 @@
+/**
+ * \file  SpscRingBuffer.h
+ * \date  Created on October 17, 2026
+ * \brief Declaration of the SpscRingBuffer class for the General Utility Library.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_SPSCRINGBUFFER_H_
+#define GUL17_SPSCRINGBUFFER_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+#include "gul17/span.h"
+
+namespace gul17 {
+
+/**
+ * \addtogroup SpscRingBuffer_h gul17/SpscRingBuffer.h
+ * \brief A lock-free ring buffer for one producer and one consumer thread.
+ * @{
+ */
+
+/**
+ * A lock-free ring buffer of fixed capacity for passing elements from exactly one
+ * producer thread to exactly one consumer thread.
+ *
+ * Like a SlidingBuffer with a fixed capacity, the elements are stored in an embedded
+ * std::array. Unlike SlidingBuffer, no element is ever dropped: If the buffer is full,
+ * the producer cannot add more elements until the consumer has removed some. All
+ * operations are wait-free and never block, so the buffer is suitable for handing data
+ * from a real-time thread to a non-real-time one (or vice versa) without a mutex.
+ *
+ * \code
+ * SpscRingBuffer<Sample, 4096> buf;
+ *
+ * // Producer thread
+ * if (not buf.try_push(sample))
+ *     ++num_overruns;
+ *
+ * // Consumer thread
+ * std::array<Sample, 256> block;
+ * auto num = buf.read(block); // Read up to 256 samples at once
+ * \endcode
+ *
+ * The producer may only call try_push() and write(), the consumer only try_pop() and
+ * read(). size() and empty() may be called from any thread, but the result is only a
+ * snapshot. The buffer itself must outlive both threads' use of it.
+ *
+ * Internally, the producer and the consumer each own a free-running counter (the
+ * position of the next write and of the next read) that is published with release
+ * semantics and read with acquire semantics by the other side. Both counters and the
+ * storage live on separate cache lines so that the two threads do not disturb each
+ * other's caches, and each side keeps a private copy of the other side's counter that
+ * is only refreshed when the buffer appears to be full or empty.
+ *
+ * \code
+ * Member types:
+ *   value_type                  Type of the elements
+ *   size_type                   Unsigned integer type (std::size_t)
+ *
+ * Member functions:
+ *     SpscRingBuffer    Constructor
+ *   Producer:
+ *     try_push          Insert an element at the back if there is space
+ *     write             Insert as many elements from a span as there is space for
+ *   Consumer:
+ *     try_pop           Remove the foremost element if there is one
+ *     read              Remove up to the given number of elements into a span
+ *   Capacity:
+ *     size              Return the number of elements (snapshot)
+ *     capacity          Return maximum number of elements
+ *     empty             Check whether the buffer is empty (snapshot)
+ * \endcode
+ *
+ * \b `ElementT` must be default constructible and move assignable. Removed elements
+ * are moved out of the buffer; the moved-from objects stay in the internal array until
+ * they are overwritten.
+ *
+ * \tparam ElementT       Type of elements in the buffer
+ * \tparam fixed_capacity Maximum number of elements in the buffer, must be a power of two
+ */
+template <typename ElementT, std::size_t fixed_capacity>
+class SpscRingBuffer
+{
+    static_assert(fixed_capacity > 0u && (fixed_capacity & (fixed_capacity - 1u)) == 0u,
+        "The capacity of a SpscRingBuffer must be a power of two");
+
+public:
+    /// Type of the elements in the buffer
+    using value_type = ElementT;
+    /// Unsigned integer type
+    using size_type = std::size_t;
+
+    /// Construct an empty buffer.
+    SpscRingBuffer() = default;
+
+    /**
+     * Insert one element at the back of the buffer if it is not full.
+     *
+     * May only be called from the producer thread.
+     *
+     * \returns true if the element was inserted, false if the buffer was full.
+     */
+    bool try_push(const value_type& in)
+    {
+        auto const end = idx_end_.load(std::memory_order_relaxed);
+        if (not has_space(end, 1u))
+            return false;
+
+        storage_[end & mask_] = in;
+        idx_end_.store(end + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * \overload
+     */
+    bool try_push(value_type&& in)
+    {
+        auto const end = idx_end_.load(std::memory_order_relaxed);
+        if (not has_space(end, 1u))
+            return false;
+
+        storage_[end & mask_] = std::move(in);
+        idx_end_.store(end + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Insert as many elements of the given span at the back of the buffer as there is
+     * space for.
+     *
+     * The elements are copied in at most two contiguous chunks and published to the
+     * consumer all at once. May only be called from the producer thread.
+     *
+     * \returns the number of elements that were inserted, i.e. the length of the prefix
+     *          of `values` that has been consumed.
+     */
+    size_type write(span<const value_type> values)
+    {
+        auto const end = idx_end_.load(std::memory_order_relaxed);
+        has_space(end, values.size()); // Refresh the cached consumer position if needed
+
+        auto const num = std::min(values.size(), fixed_capacity - (end - cached_begin_));
+        auto const pos = end & mask_;
+        auto const num_first = std::min(num, fixed_capacity - pos);
+
+        auto const mid = values.begin() + static_cast<std::ptrdiff_t>(num_first);
+        std::copy(values.begin(), mid,
+            storage_.begin() + static_cast<std::ptrdiff_t>(pos));
+        std::copy(mid, values.begin() + static_cast<std::ptrdiff_t>(num),
+            storage_.begin());
+
+        idx_end_.store(end + num, std::memory_order_release);
+        return num;
+    }
+
+    /**
+     * Remove the foremost element from the buffer if it is not empty.
+     *
+     * May only be called from the consumer thread.
+     *
+     * \param out  Reference to which the removed element is move-assigned
+     * \returns true if an element was removed, false if the buffer was empty.
+     */
+    bool try_pop(value_type& out)
+    {
+        auto const begin = idx_begin_.load(std::memory_order_relaxed);
+        if (count_available(begin, 1u) == 0u)
+            return false;
+
+        out = std::move(storage_[begin & mask_]);
+        idx_begin_.store(begin + 1u, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Remove up to `out.size()` elements from the front of the buffer and move them into
+     * the given span.
+     *
+     * The elements are moved in at most two contiguous chunks, and the space is released
+     * to the producer all at once. May only be called from the consumer thread.
+     *
+     * \returns the number of elements that were removed.
+     */
+    size_type read(span<value_type> out)
+    {
+        auto const begin = idx_begin_.load(std::memory_order_relaxed);
+        auto const num = std::min(out.size(), count_available(begin, out.size()));
+        auto const pos = begin & mask_;
+        auto const num_first = std::min(num, fixed_capacity - pos);
+
+        auto const mid = std::move(storage_.begin() + static_cast<std::ptrdiff_t>(pos),
+            storage_.begin() + static_cast<std::ptrdiff_t>(pos + num_first), out.begin());
+        std::move(storage_.begin(),
+            storage_.begin() + static_cast<std::ptrdiff_t>(num - num_first), mid);
+
+        idx_begin_.store(begin + num, std::memory_order_release);
+        return num;
+    }
+
+    /**
+     * Return the number of elements in the buffer.
+     *
+     * If called while the other thread modifies the buffer, the result may already be
+     * outdated when the function returns.
+     */
+    size_type size() const noexcept
+    {
+        auto const begin = idx_begin_.load(std::memory_order_acquire);
+        auto const end = idx_end_.load(std::memory_order_acquire);
+        return std::min(end - begin, fixed_capacity);
+    }
+
+    /// Return the maximum possible number of elements in the buffer.
+    static constexpr size_type capacity() noexcept
+    {
+        return fixed_capacity;
+    }
+
+    /**
+     * Check if the buffer contains no elements.
+     *
+     * If called while the other thread modifies the buffer, the result may already be
+     * outdated when the function returns.
+     */
+    bool empty() const noexcept
+    {
+        return size() == 0u;
+    }
+
+private:
+    static constexpr size_type mask_ = fixed_capacity - 1u;
+
+    /// Position of the next element to be read, written by the consumer.
+    alignas(64) std::atomic<size_type> idx_begin_{ 0u };
+    /// The consumer's copy of idx_end_, only refreshed if the buffer appears empty.
+    size_type cached_end_{ 0u };
+
+    /// Position of the next element to be written, written by the producer.
+    alignas(64) std::atomic<size_type> idx_end_{ 0u };
+    /// The producer's copy of idx_begin_, only refreshed if the buffer appears full.
+    size_type cached_begin_{ 0u };
+
+    /// The elements, on cache lines of their own.
+    alignas(64) std::array<value_type, fixed_capacity> storage_{ };
+
+    /**
+     * Check if there is space for num elements behind the given end position (producer
+     * side). The consumer position is only reloaded if the cached one says no.
+     */
+    bool has_space(size_type end, size_type num) noexcept
+    {
+        if (fixed_capacity - (end - cached_begin_) >= num)
+            return true;
+
+        cached_begin_ = idx_begin_.load(std::memory_order_acquire);
+        return fixed_capacity - (end - cached_begin_) >= num;
+    }
+
+    /**
+     * Return the number of elements that are available for reading from the given begin
+     * position (consumer side). The producer position is only reloaded if the cached one
+     * says that there are fewer than num elements.
+     */
+    size_type count_available(size_type begin, size_type num) noexcept
+    {
+        if (cached_end_ - begin < num)
+            cached_end_ = idx_end_.load(std::memory_order_acquire);
+
+        return cached_end_ - begin;
+    }
+};
+
+/// @}
+
+} // namespace gul17
+
+#endif
+
+// vi:ts=4:sw=4:sts=4:et
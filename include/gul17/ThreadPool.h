@@ -26,15 +26,28 @@
 #ifndef GUL17_THREADPOOL_H_
 #define GUL17_THREADPOOL_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <future>
+#include <iosfwd>
+#include <iterator>
 #include <limits>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <ratio>
 #include <stdexcept>
+#include <string>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #include <gul17/cat.h>
@@ -49,6 +62,133 @@ namespace detail {
 GUL_EXPORT
 std::shared_ptr<ThreadPool> lock_pool_or_throw(std::weak_ptr<ThreadPool> pool);
 
+/**
+ * A move-only, type-erased function object with the signature `void(ThreadPool&)`.
+ *
+ * Function objects up to a size of inline_size bytes that can be moved without throwing
+ * are stored inside the object itself; only larger ones are allocated on the heap. This
+ * allows ThreadPool to enqueue small detached tasks without any dynamic allocation.
+ */
+class InlineTaskFunction
+{
+public:
+    /// Maximum size of a function object that is stored without heap allocation.
+    constexpr static std::size_t inline_size{ 6 * sizeof(void*) };
+
+    /// Construct an empty function object.
+    InlineTaskFunction() noexcept = default;
+
+    /// Construct a function object from a callable `void fct(ThreadPool&)`.
+    template <typename Function,
+        std::enable_if_t<
+            not std::is_same<std::decay_t<Function>, InlineTaskFunction>::value, bool>
+            = true>
+    InlineTaskFunction(Function&& fct)
+    {
+        using F = std::decay_t<Function>;
+
+        if constexpr (fits_inline<F>())
+        {
+            new (&buffer_) F(std::forward<Function>(fct));
+            vtable_ = &inline_vtable<F>;
+        }
+        else
+        {
+            new (&buffer_) F*(new F(std::forward<Function>(fct)));
+            vtable_ = &heap_vtable<F>;
+        }
+    }
+
+    InlineTaskFunction(InlineTaskFunction&& other) noexcept
+    {
+        move_from(other);
+    }
+
+    InlineTaskFunction& operator=(InlineTaskFunction&& other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            move_from(other);
+        }
+        return *this;
+    }
+
+    ~InlineTaskFunction() { reset(); }
+
+    /// Determine whether the object holds a function.
+    explicit operator bool() const noexcept { return vtable_ != nullptr; }
+
+    /// Call the stored function.
+    void operator()(ThreadPool& pool) { vtable_->invoke(&buffer_, pool); }
+
+private:
+    struct VTable
+    {
+        void (*invoke)(void* buffer, ThreadPool& pool);
+        void (*move)(void* dest, void* src) noexcept; // Move-construct dest, destroy src
+        void (*destroy)(void* buffer) noexcept;
+    };
+
+    template <typename F>
+    constexpr static bool fits_inline() noexcept
+    {
+        return sizeof(F) <= inline_size && alignof(F) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible<F>::value;
+    }
+
+    template <typename F>
+    constexpr static VTable inline_vtable{
+        [](void* buffer, ThreadPool& pool) { (*static_cast<F*>(buffer))(pool); },
+        [](void* dest, void* src) noexcept
+        {
+            new (dest) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        },
+        [](void* buffer) noexcept { static_cast<F*>(buffer)->~F(); }
+    };
+
+    template <typename F>
+    constexpr static VTable heap_vtable{
+        [](void* buffer, ThreadPool& pool) { (**static_cast<F**>(buffer))(pool); },
+        [](void* dest, void* src) noexcept
+        {
+            new (dest) F*(*static_cast<F**>(src));
+        },
+        [](void* buffer) noexcept { delete *static_cast<F**>(buffer); }
+    };
+
+    alignas(std::max_align_t) unsigned char buffer_[inline_size];
+    const VTable* vtable_{ nullptr };
+
+    void move_from(InlineTaskFunction& other) noexcept
+    {
+        if (other.vtable_ == nullptr)
+            return;
+
+        other.vtable_->move(&buffer_, &other.buffer_);
+        vtable_ = other.vtable_;
+        other.vtable_ = nullptr;
+    }
+
+    void reset() noexcept
+    {
+        if (vtable_ == nullptr)
+            return;
+
+        vtable_->destroy(&buffer_);
+        vtable_ = nullptr;
+    }
+};
+
+/// State shared between a periodic task and its handle.
+struct PeriodicTaskState
+{
+    std::atomic<std::uint64_t> num_runs_{ 0 };
+    std::atomic<std::uint64_t> num_overruns_{ 0 };
+    std::atomic<bool> canceled_{ false };
+};
+
 } // namespace detail
 
 /**
@@ -71,6 +211,168 @@ enum class TaskState
     canceled  ///< The task was removed from the queue before it was started.
 };
 
+/**
+ * An enum describing the priority of a task.
+ *
+ * Among the tasks that are ready to be started, a ThreadPool always starts one with the
+ * highest priority first. Tasks of the same priority are started in the order in which
+ * they became ready.
+ */
+enum class TaskPriority
+{
+    low,    ///< For background work that may be delayed by other tasks.
+    normal, ///< The default priority.
+    high    ///< For latency-critical tasks.
+};
+
+/// An enum describing how a periodic task is rescheduled after each execution.
+enum class PeriodicTaskMode
+{
+    /**
+     * The task is started at fixed intervals: The n-th execution is scheduled for
+     * n periods after the first one, independent of how long the executions take. If an
+     * execution takes so long that one or more of the following start times have already
+     * passed, these are skipped and counted as overruns.
+     */
+    fixed_rate,
+    /// Each execution is scheduled one period after the previous one has finished.
+    fixed_delay
+};
+
+/// An enum describing what ThreadPool::shutdown() does with pending tasks.
+enum class ShutdownMode
+{
+    /**
+     * Execute all pending tasks (including the ones that are added in the meantime)
+     * before the worker threads are stopped.
+     */
+    drain,
+    /// Cancel all pending tasks; only the tasks that are already running are finished.
+    discard
+};
+
+/**
+ * An enum describing the scheduling policy of the worker threads of a ThreadPool.
+ *
+ * The policies correspond to the POSIX policies SCHED_OTHER, SCHED_FIFO, and SCHED_RR.
+ * The real-time policies usually require special privileges.
+ */
+enum class ThreadSchedulingPolicy
+{
+    inherit,    ///< Keep the policy of the thread that creates the pool.
+    other,      ///< The default time-sharing policy (SCHED_OTHER).
+    fifo,       ///< Real-time first-in, first-out policy (SCHED_FIFO).
+    round_robin ///< Real-time round-robin policy (SCHED_RR).
+};
+
+/**
+ * A token that lets a running task find out whether it has been asked to stop.
+ *
+ * A task receives a StopToken if its function object takes one as the last argument
+ * (`T fct(StopToken)` or `T fct(ThreadPool&, StopToken)`). A stop is requested via
+ * \ref gul17::ThreadPool::TaskHandle::request_stop() "request_stop()" on the handle of
+ * the task. Checking the token is a single atomic load without any locking, so a task can
+ * afford to do it frequently, e.g. once per iteration of its main loop. It is up to the
+ * task how to react to the request.
+ *
+ * \code{.cpp}
+ * auto pool = make_thread_pool(2);
+ * auto handle = pool->add_task(
+ *     [](StopToken token)
+ *     {
+ *         while (not token.stop_requested())
+ *             process_next_block();
+ *     });
+ * ...
+ * handle.request_stop();
+ * \endcode
+ */
+class StopToken
+{
+public:
+    /// Default-construct a token for which a stop is never requested.
+    StopToken() = default;
+
+    /// Determine whether a stop has been requested.
+    bool stop_requested() const noexcept
+    {
+        return state_ && state_->load(std::memory_order_acquire);
+    }
+
+private:
+    friend class ThreadPool;
+
+    explicit StopToken(std::shared_ptr<std::atomic<bool>> state)
+        : state_{ std::move(state) }
+    {}
+
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+namespace detail {
+
+/**
+ * Determine whether a function object for a ThreadPool task takes a StopToken as its
+ * last argument (and cannot be called without it).
+ */
+template <typename Function>
+constexpr bool takes_stop_token_v =
+    not std::is_invocable<Function, ThreadPool&>::value
+    && not std::is_invocable<Function>::value
+    && (std::is_invocable<Function, StopToken>::value
+        || std::is_invocable<Function, ThreadPool&, StopToken>::value);
+
+template <typename T>
+class TaskHandleAwaiter; // Defined in gul17/coroutine.h
+
+/**
+ * Return the time point at which a timeout starting now expires.
+ *
+ * Instead of overflowing, the result saturates at time_point::max() (i.e. "never") for
+ * very long timeouts such as duration::max(). The timeout is only converted to the
+ * resolution of the steady clock after this check, so coarse duration types (e.g.
+ * std::chrono::hours or a system_clock::duration with microsecond ticks) cannot
+ * overflow in the conversion either. Negative timeouts expire immediately.
+ */
+template <typename Rep, typename Period>
+std::chrono::steady_clock::time_point
+get_deadline(std::chrono::duration<Rep, Period> timeout)
+{
+    using SteadyTimePoint = std::chrono::steady_clock::time_point;
+    using SteadyDuration = SteadyTimePoint::duration;
+
+    const auto now = std::chrono::steady_clock::now();
+
+    if (timeout <= timeout.zero())
+        return now;
+
+    if constexpr (std::ratio_less_equal<SteadyDuration::period, Period>::value)
+    {
+        // Compare in the unit of the timeout, using a representation that is wide enough
+        // for the remaining time of the clock
+        using WideDuration =
+            std::chrono::duration<std::common_type_t<Rep, SteadyDuration::rep>, Period>;
+
+        const auto max_timeout =
+            std::chrono::duration_cast<WideDuration>(SteadyTimePoint::max() - now);
+        if (timeout >= max_timeout)
+            return SteadyTimePoint::max();
+
+        return now + std::chrono::duration_cast<SteadyDuration>(timeout);
+    }
+    else
+    {
+        // A timeout with a finer resolution than the clock can only get smaller
+        const auto steady_timeout = std::chrono::duration_cast<SteadyDuration>(timeout);
+        if (steady_timeout >= SteadyTimePoint::max() - now)
+            return SteadyTimePoint::max();
+
+        return now + steady_timeout;
+    }
+}
+
+} // namespace detail
+
 /**
  * A pool of worker threads with a task queue.
  *
@@ -97,8 +399,20 @@ enum class TaskState
  * \endcode
  *
  * Tasks can also be scheduled to start after a specific time point or after a certain
- * delay. Each task can also be given a name, which is mainly useful for debugging. See
- * the \ref thread_pool.cc "example" for an introduction.
+ * delay. Such tasks wait in a separate queue ordered by their start time and join the
+ * end of the regular queue when their time has come. Each task can also be given a name,
+ * which is mainly useful for debugging. See the \ref thread_pool.cc "example" for an
+ * introduction.
+ *
+ * By default, all threads share a single task queue. Alternatively, a pool can be created
+ * with per-thread queues and work stealing (see \ref ThreadPool::Options::work_stealing
+ * "Options::work_stealing"), which reduces contention for pools with many threads and
+ * many small tasks.
+ *
+ * Tasks can depend on each other: TaskHandle::then() adds a continuation that is started
+ * after a task has finished, and add_task_graph() enqueues a whole graph of tasks with
+ * dependencies. Waiting tasks are kept aside until their predecessors have finished, so
+ * no worker thread is blocked in the meantime.
  *
  * All public member functions are thread-safe.
  *
@@ -110,11 +424,16 @@ enum class TaskState
  */
 class ThreadPool : public std::enable_shared_from_this<ThreadPool>
 {
+    struct NamedTask; // Defined in the private section below
+
 public:
     /// A unique identifier for a task.
     using TaskId = std::uint64_t;
 
-    /// A unique identifier for a thread in the pool in the range of [0, count_threads()).
+    /**
+     * A unique identifier for a thread in the pool in the range of [0, n), where n is the
+     * maximum number of threads (see Options::max_num_threads).
+     */
     using ThreadId = std::vector<std::thread>::size_type;
 
     /**
@@ -157,11 +476,15 @@ public:
          *                task
          * \param pool    A shared pointer to the ThreadPool that the task is associated
          *                with
+         * \param stop_state  The flag behind the StopToken of the task (null if the task
+         *                does not take a StopToken)
          */
-        TaskHandle(TaskId id, std::future<T> future, std::shared_ptr<ThreadPool> pool)
+        TaskHandle(TaskId id, std::future<T> future, std::shared_ptr<ThreadPool> pool,
+            std::shared_ptr<std::atomic<bool>> stop_state = {})
             : future_{ std::move(future) }
             , id_{ id }
             , pool_{ std::move(pool) }
+            , stop_state_{ std::move(stop_state) }
         {}
 
         /**
@@ -181,6 +504,23 @@ public:
             return detail::lock_pool_or_throw(pool_)->cancel_pending_task(id_);
         }
 
+        /**
+         * Ask the task to stop.
+         *
+         * This sets the StopToken that is passed to the task if its function object takes
+         * one. The request is only a hint: A running task stops when it next checks its
+         * token, and a task that is still pending sees the request as soon as it starts.
+         * To remove a pending task from the queue, use cancel(). This function does not
+         * interact with the ThreadPool and does not block.
+         *
+         * \returns true if the task takes a StopToken and no stop had been requested
+         *          before, false otherwise.
+         */
+        bool request_stop() noexcept
+        {
+            return stop_state_ && not stop_state_->exchange(true);
+        }
+
         /**
          * Block until the task has finished and return its result.
          *
@@ -240,351 +580,2134 @@ public:
             return static_cast<TaskState>(state);
         }
 
+        /**
+         * Enqueue a continuation that is started once this task has finished.
+         *
+         * The continuation is added to the same pool right away, but it stays pending
+         * until this task has finished. No thread is blocked while waiting. The result
+         * of this task is passed to the continuation as its only argument; for a task
+         * without a result (`T = void`), the continuation takes no arguments.
+         *
+         * If this task throws an exception or gets canceled before it is started, the
+         * continuation is not called. Instead, the exception (or a std::future_error
+         * with the error code broken_promise) is forwarded to the handle of the
+         * continuation.
+         *
+         * The result of this task is handed over to the continuation. Therefore, then()
+         * can only be called on an rvalue, and the original handle must not be used
+         * anymore afterwards.
+         *
+         * \param fct   A function object with signature `U fct(T)` (or `U fct()` if T is
+         *              void)
+         * \param name  Optional name for the continuation (mainly for debugging)
+         *
+         * \returns a TaskHandle for the continuation.
+         *
+         * \exception std::logic_error is thrown if the task has no result (e.g. because it
+         *            has been canceled via this handle) or if the associated thread pool
+         *            does not exist anymore. std::runtime_error is thrown if the queue is
+         *            full.
+         *
+         * \code{.cpp}
+         * auto pool = make_thread_pool(2);
+         * auto handle = pool->add_task([]() { return read_samples(); })
+         *     .then([](std::vector<double> samples) { return average(samples); })
+         *     .then([](double avg) { std::cout << "Average: " << avg << "\n"; });
+         * \endcode
+         */
+        template <typename Function>
+        auto then(Function fct, std::string name = {}) &&
+        {
+            auto pool = detail::lock_pool_or_throw(pool_);
+
+            if (not future_.valid())
+                throw std::logic_error("Cannot add a continuation to a task without result");
+
+            auto continuation =
+                [f = std::move(fct), future = std::move(future_)](ThreadPool&) mutable
+                {
+                    // The predecessor has finished, so get() returns immediately
+                    if constexpr (std::is_void<T>::value)
+                    {
+                        future.get();
+                        return f();
+                    }
+                    else
+                    {
+                        return f(future.get());
+                    }
+                };
+
+            return pool->add_task_after(std::move(continuation), { id_ }, std::move(name));
+        }
+
     private:
+        friend class detail::TaskHandleAwaiter<T>;
+
         std::future<T> future_;
         TaskId id_{ 0 };
         std::weak_ptr<ThreadPool> pool_;
-    };
+        std::shared_ptr<std::atomic<bool>> stop_state_;
 
+        /**
+         * Enqueue a function that is called with the future of this task once the task
+         * has finished or has been canceled. Unlike a continuation added with then(), the
+         * function is also called if the task fails. The handle has no result anymore
+         * afterwards.
+         *
+         * If the function cannot be enqueued (e.g. because the queue is full), the
+         * exception is passed on and the handle keeps its result.
+         */
+        template <typename Function>
+        void when_finished(Function fct)
+        {
+            auto pool = detail::lock_pool_or_throw(pool_);
 
-    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
-    using Duration = TimePoint::duration;
-
-    /// Default capacity for the task queue.
-    constexpr static std::size_t default_capacity{ 200 };
+            if (not future_.valid())
+                throw std::logic_error("Cannot wait for a task without result");
 
-    /// Maximum possible capacity for the task queue.
-    constexpr static std::size_t max_capacity{ 10'000'000 };
+            // The continuation only shares the future so that it can be taken back if
+            // the continuation is not accepted by the pool
+            auto future = std::make_shared<std::future<T>>(std::move(future_));
 
-    /// Maximum possible number of threads
-    constexpr static std::size_t max_threads{ 10'000 };
+            auto continuation =
+                [f = std::move(fct), future](ThreadPool&) mutable
+                {
+                    f(std::move(*future));
+                };
 
-    /**
-     * Destruct the ThreadPool and join all threads.
-     *
-     * This destructor blocks until all threads have terminated. Work that has not yet
-     * been started in one of the threads gets canceled, but work that has already been
-     * assigned to a thread continues to be executed until it completes.
-     */
-    ~ThreadPool();
+            try
+            {
+                pool->add_task_after(std::move(continuation), { id_ }, {});
+            }
+            catch (...)
+            {
+                future_ = std::move(*future);
+                throw;
+            }
+        }
+    };
 
     /**
-     * Enqueue a task.
+     * A set of tasks with dependencies between them (a directed acyclic graph).
      *
-     * There are multiple overloads of this function for variations of the arguments:
-     *
-     * \param fct   A function object or function pointer to be executed. This function
-     *              can have an arbitrary return type and may either take no arguments
-     *              (`T fct()`) or a reference to the ThreadPool by which it gets
-     *              executed (`T fct(ThreadPool&)`).
-     * \param start_time  Earliest time point at which the task is to be started
-     * \param name  Optional name for the task (mainly for debugging)
+     * Nodes are added with add_node(), each one with a list of nodes that it depends on.
+     * Because a node can only depend on nodes that have been added before, the graph is
+     * acyclic by construction. ThreadPool::add_task_graph() enqueues all nodes at once;
+     * the pool starts a node as soon as all of its dependencies have finished, without
+     * blocking any thread while waiting.
      *
-     * \returns a TaskHandle that can be used for inquiries about the state of the task
-     *          and to retrieve its return value.
-     * \exception std::runtime_error is thrown if the queue is full.
+     * The return values of the node functions are discarded. Results can be passed
+     * between nodes via captured variables.
      *
      * \code{.cpp}
-     * auto pool = make_thread_pool(2); // Create a pool with 2 threads
-     *
-     * // A simple task that does not interact with the pool
-     * pool->add_task([]() { std::cout << "Task 1\n"; });
-     *
-     * // A task that schedules another task to start two seconds later
-     * pool->add_task(
-     *     [](ThreadPool& pool)
-     *     {
-     *         std::cout << "Task 2\n";
-     *         pool.add_task([]() { std::cout << "Task 3\n"; }, 2s);
-     *     });
+     * ThreadPool::TaskGraph graph;
+     * auto load = graph.add_node([&]() { data = load(); }, {}, "load");
+     * auto filter = graph.add_node([&]() { filter(data); }, { load }, "filter");
+     * auto stats = graph.add_node([&]() { stats = statistics(data); }, { load }, "stats");
+     * graph.add_node([&]() { store(data, stats); }, { filter, stats }, "store");
      *
-     * // A task with a name
-     * pool->add_task([]() { std::cout << "Task 4\n"; }, "Task 4");
+     * auto pool = make_thread_pool(4);
+     * auto handles = pool->add_task_graph(std::move(graph));
+     * handles.back().get_result(); // Wait for the "store" task
      * \endcode
-     *
-     * \since GUL version 2.12.1, add_task() unconditionally accepts mutable function
-     *        objects
      */
-    template <typename Function>
-    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
-    add_task(Function fct, TimePoint start_time = {}, std::string name = {})
+    class TaskGraph
     {
-        static_assert(
-            std::is_invocable<Function, ThreadPool&>::value
-            || std::is_invocable<Function>::value,
-            "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
+    public:
+        /// Index of a node in the graph.
+        using NodeId = std::size_t;
 
-        using Result = std::invoke_result_t<Function, ThreadPool&>;
+        /**
+         * Add a task to the graph.
+         *
+         * \param fct   A function object with signature `T fct()` or `T fct(ThreadPool&)`.
+         *              Its return value is discarded.
+         * \param dependencies  Nodes that have to finish before this one is started
+         * \param name  Optional name for the task (mainly for debugging)
+         *
+         * \returns the ID of the new node. Node IDs are consecutive numbers starting at
+         *          zero.
+         *
+         * \exception std::invalid_argument is thrown if one of the dependencies does not
+         *            refer to a node that has already been added.
+         */
+        template <typename Function>
+        NodeId add_node(Function fct, std::vector<NodeId> dependencies = {},
+            std::string name = {})
+        {
+            static_assert(
+                std::is_invocable<Function, ThreadPool&>::value
+                || std::is_invocable<Function>::value,
+                "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
 
-        TaskHandle<Result> task_handle = [this, &fct, start_time, &name]()
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
+            const NodeId id = nodes_.size();
 
-                if (is_full_i())
+            for (const auto dependency : dependencies)
+            {
+                if (dependency >= id)
                 {
-                    throw std::runtime_error(cat(
-                        "Cannot add task: Pending queue has reached capacity (",
-                        pending_tasks_.size(), ')'));
+                    throw std::invalid_argument(cat("Node ", id,
+                        " cannot depend on node ", dependency, " (not added yet)"));
                 }
+            }
 
-                using PackagedTask = std::packaged_task<Result(ThreadPool&)>;
+            using PackagedTask = std::packaged_task<void(ThreadPool&)>;
 
-                auto named_task_ptr = std::make_unique<NamedTaskImpl<PackagedTask>>(
-                    PackagedTask{ std::move(fct) }, std::move(name));
+            auto named_task_ptr = std::make_unique<NamedTaskImpl<PackagedTask>>(
+                PackagedTask{ track_exceptions(with_pool_argument(std::move(fct))) },
+                std::move(name));
+            auto future = named_task_ptr->fct_.get_future();
 
-                TaskHandle<Result> handle{
-                    next_task_id_, named_task_ptr->fct_.get_future(), shared_from_this() };
+            nodes_.push_back(Node{ std::move(named_task_ptr), std::move(future),
+                std::move(dependencies) });
 
-                pending_tasks_.emplace_back(
-                    next_task_id_, std::move(named_task_ptr), start_time);
+            return id;
+        }
 
-                ++next_task_id_;
+        /// Return the number of nodes in the graph.
+        std::size_t size() const noexcept { return nodes_.size(); }
 
-                return handle;
-            }();
+    private:
+        friend class ThreadPool;
 
-        cv_.notify_one();
+        struct Node
+        {
+            std::unique_ptr<NamedTask> named_task_;
+            std::future<void> future_;
+            std::vector<NodeId> dependencies_;
+        };
 
-        return task_handle;
-    }
+        std::vector<Node> nodes_;
+    };
 
-    template <typename Function,
-        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
-    TaskHandle<std::invoke_result_t<Function>>
-    add_task(Function fct, TimePoint start_time = {}, std::string name = {})
-    {
-        return add_task(
-            [f = std::move(fct)](ThreadPool&) mutable { return f(); },
-            start_time, std::move(name));
-    }
 
-    template <typename Function,
-        std::enable_if_t<std::is_invocable<Function, ThreadPool&>::value, bool> = true>
-    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
-    add_task(Function fct, Duration delay_before_start, std::string name = {})
+    /**
+     * A handle for a periodic task that has been enqueued on a ThreadPool with
+     * add_periodic_task().
+     *
+     * The handle can be used to stop the task and to inquire how often it has been
+     * executed so far.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(1);
+     * auto task = pool->add_periodic_task([]() { poll_device(); }, 100ms);
+     * sleep(1);
+     * std::cout << "Task has run " << task.count_runs() << " times\n";
+     * task.cancel();
+     * \endcode
+     */
+    class PeriodicTaskHandle
     {
-        return add_task(std::move(fct),
-            std::chrono::system_clock::now() + delay_before_start, std::move(name));
-    }
+    public:
+        /**
+         * Default-construct an invalid PeriodicTaskHandle.
+         *
+         * This constructor creates an invalid handle which is not associated with a
+         * ThreadPool.
+         */
+        PeriodicTaskHandle()
+        {}
 
-    template <typename Function,
-        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
-    TaskHandle<std::invoke_result_t<Function>>
-    add_task(Function fct, Duration delay_before_start, std::string name = {})
+        /**
+         * Construct a PeriodicTaskHandle.
+         *
+         * This constructor is not meant to be used directly. Instead, handles are
+         * returned by ThreadPool::add_periodic_task().
+         *
+         * \param id     Unique ID of the task
+         * \param state  State shared between the task and its handles
+         * \param pool   A shared pointer to the ThreadPool that the task is associated
+         *               with
+         */
+        PeriodicTaskHandle(TaskId id, std::shared_ptr<detail::PeriodicTaskState> state,
+            std::shared_ptr<ThreadPool> pool)
+            : state_{ std::move(state) }
+            , id_{ id }
+            , pool_{ std::move(pool) }
+        {}
+
+        /**
+         * Stop the periodic execution of the task.
+         *
+         * If the task is pending, it is removed from the queue. If it is currently
+         * running, the current execution continues, but the task is not rescheduled.
+         *
+         * \returns true if the task was stopped by this call, false if it had already
+         *          been canceled before.
+         *
+         * \exception std::logic_error is thrown if the associated thread pool does not
+         *            exist anymore.
+         */
+        bool cancel()
+        {
+            auto pool = detail::lock_pool_or_throw(pool_);
+
+            if (state_->canceled_.exchange(true))
+                return false;
+
+            pool->cancel_pending_task(id_);
+            return true;
+        }
+
+        /// Return how often the task has been executed so far.
+        std::uint64_t count_runs() const noexcept
+        {
+            return state_ ? state_->num_runs_.load() : 0;
+        }
+
+        /**
+         * Return how many start times have been skipped because a previous execution
+         * was not finished in time (only for PeriodicTaskMode::fixed_rate).
+         */
+        std::uint64_t count_overruns() const noexcept
+        {
+            return state_ ? state_->num_overruns_.load() : 0;
+        }
+
+        /**
+         * Determine if the task is running, waiting to be started, or has been canceled.
+         *
+         * \exception std::logic_error is thrown if the associated thread pool does not
+         *            exist anymore.
+         */
+        TaskState get_state() const
+        {
+            const auto state = detail::lock_pool_or_throw(pool_)->get_task_state(id_);
+
+            if (state == InternalTaskState::unknown)
+                return TaskState::canceled;
+
+            return static_cast<TaskState>(state);
+        }
+
+    private:
+        std::shared_ptr<detail::PeriodicTaskState> state_;
+        TaskId id_{ 0 };
+        std::weak_ptr<ThreadPool> pool_;
+    };
+
+    /**
+     * A time point of the system clock.
+     *
+     * Start times given as a TimePoint are converted into the steady timeline of the pool
+     * when the task is added. Later adjustments of the system clock (e.g. by NTP) do
+     * therefore not delay or hasten the start of a task.
+     */
+    using TimePoint = std::chrono::time_point<std::chrono::system_clock>;
+    using Duration = TimePoint::duration;
+
+    /// A time point of the steady clock, which is used internally for scheduling tasks.
+    using SteadyTimePoint = std::chrono::time_point<std::chrono::steady_clock>;
+
+    /// Default capacity for the task queue.
+    constexpr static std::size_t default_capacity{ 200 };
+
+    /// Maximum possible capacity for the task queue.
+    constexpr static std::size_t max_capacity{ 10'000'000 };
+
+    /// Maximum possible number of threads
+    constexpr static std::size_t max_threads{ 10'000 };
+
+    /**
+     * A set of options for the construction of a ThreadPool.
+     *
+     * \code{.cpp}
+     * ThreadPool::Options options;
+     * options.num_threads = 16;
+     * options.work_stealing = true;
+     * auto pool = make_thread_pool(options);
+     * \endcode
+     */
+    struct Options
+    {
+        /// Number of worker threads (the minimum number if the pool scales dynamically).
+        std::size_t num_threads{ 1 };
+
+        /// Maximum number of pending tasks that can be queued.
+        std::size_t capacity{ default_capacity };
+
+        /**
+         * Give each worker thread its own task queue and let idle threads steal work
+         * from the others.
+         *
+         * In this mode, tasks that are added without a start time from within one of the
+         * pool's worker threads are pushed onto the local queue of that thread without
+         * touching the shared queue. A worker executes the newest task from its own queue
+         * first; idle workers steal the oldest tasks from the queues of other threads.
+         * Tasks that are added from outside of the pool or with a start time are still
+         * passed through the shared queue.
+         *
+         * Task handles, cancellation, and the inquiry functions work as usual, but tasks
+         * are no longer guaranteed to be executed in the order they were added.
+         */
+        bool work_stealing{ false };
+
+        /**
+         * Starvation protection for tasks with a low priority.
+         *
+         * If this duration is nonzero, a task that is ready to be started is treated as
+         * if its priority was one level higher for each full interval of this length
+         * that it has been waiting. This guarantees that tasks with a low priority are
+         * eventually started even if tasks with a higher priority are added
+         * continuously. The default of zero means strict priorities.
+         */
+        Duration priority_aging{ Duration::zero() };
+
+        /**
+         * Collect runtime metrics that can be retrieved with get_metrics().
+         *
+         * Each worker thread records its measurements in its own set of counters, so the
+         * overhead is limited to two reads of the steady clock per task.
+         */
+        bool collect_metrics{ false };
+
+        /**
+         * Maximum number of worker threads for a dynamically scaling pool.
+         *
+         * If this is greater than num_threads, the pool starts with num_threads threads
+         * and launches additional ones whenever a ready task from the shared queue has
+         * been waiting longer than spawn_latency while no thread is idle. Threads in
+         * excess of num_threads terminate after they have been idle for keep_alive. The
+         * default of zero means a fixed number of num_threads threads.
+         */
+        std::size_t max_num_threads{ 0 };
+
+        /**
+         * Queue latency above which a dynamically scaling pool launches an additional
+         * thread (see max_num_threads).
+         */
+        Duration spawn_latency{ std::chrono::milliseconds{ 10 } };
+
+        /**
+         * Idle time after which a thread in excess of num_threads terminates in a
+         * dynamically scaling pool (see max_num_threads).
+         */
+        Duration keep_alive{ std::chrono::seconds{ 60 } };
+
+        /**
+         * Pin each worker thread to a single CPU.
+         *
+         * If this flag is set, the worker thread with ID i is pinned to the CPU
+         * `cpus[i % cpus.size()]`. If cpus is empty, the threads are distributed
+         * round-robin over all CPUs on which the process is allowed to run. Pinned
+         * threads keep their caches warm and, on NUMA systems, allocate memory on their
+         * local node. Pinning is only supported on Linux; get_thread_cpu() tells which
+         * CPU a thread has actually been pinned to.
+         */
+        bool pin_threads{ false };
+
+        /// List of CPU numbers for pin_threads (empty for all available CPUs).
+        std::vector<int> cpus{};
+
+        /**
+         * Prefix for the names of the worker threads.
+         *
+         * If this string is not empty, each worker thread is named after the prefix
+         * followed by its thread ID (e.g. "dsp0", "dsp1", ...) so that it can be told
+         * apart in debuggers and system monitors. Linux truncates the names to 15
+         * characters.
+         */
+        std::string thread_name{};
+
+        /**
+         * Scheduling policy for the worker threads.
+         *
+         * If the policy cannot be set (e.g. because the process lacks the privileges for
+         * a real-time policy), the threads keep running with the inherited policy.
+         */
+        ThreadSchedulingPolicy scheduling_policy{ ThreadSchedulingPolicy::inherit };
+
+        /**
+         * Static priority for the scheduling policy. For the real-time policies, this
+         * must be in the range allowed by the system (typically 1 to 99), otherwise it
+         * must be zero.
+         */
+        int scheduling_priority{ 0 };
+
+        /**
+         * Time for which an idle worker thread keeps polling for new tasks before it
+         * goes to sleep.
+         *
+         * A worker that finds new work while polling does not need to be woken up, which
+         * saves a system call and a context switch on both sides. This pays off for pools
+         * that are fed with a steady stream of small tasks, at the price of some CPU time
+         * burnt by idle threads. A few tens of microseconds are usually enough. The
+         * default of zero means that idle threads go to sleep right away.
+         */
+        Duration spin_time{ Duration::zero() };
+
+        /**
+         * Number of task executions that each worker thread records for get_trace().
+         *
+         * Each worker keeps the most recent executions in a ring buffer of this size,
+         * which is allocated when the pool is created. The default of zero disables
+         * tracing.
+         */
+        std::size_t trace_capacity{ 0 };
+    };
+
+    /**
+     * A histogram of durations with logarithmic bucket sizes.
+     *
+     * Bucket 0 counts durations below 1 µs, bucket i (for i > 0) counts durations in the
+     * range [2^(i-1) µs, 2^i µs). The last bucket also counts all longer durations.
+     */
+    struct DurationHistogram
+    {
+        /// Number of buckets.
+        constexpr static std::size_t num_buckets{ 32 };
+
+        /// Number of measurements in each bucket.
+        std::array<std::uint64_t, num_buckets> counts{};
+
+        /// Return the exclusive upper bound of the durations counted in a bucket.
+        static Duration get_upper_bound(std::size_t bucket)
+        {
+            if (bucket + 1 >= num_buckets)
+                return Duration::max();
+
+            return std::chrono::duration_cast<Duration>(
+                std::chrono::microseconds{ std::int64_t{ 1 } << bucket });
+        }
+
+        /// Return the index of the bucket that counts the given duration.
+        template <typename Rep, typename Period>
+        static std::size_t
+        get_bucket(std::chrono::duration<Rep, Period> duration) noexcept
+        {
+            using std::chrono::microseconds;
+            auto us = std::chrono::duration_cast<microseconds>(duration).count();
+
+            std::size_t bucket = 0;
+            while (us > 0 && bucket + 1 < num_buckets)
+            {
+                us >>= 1;
+                ++bucket;
+            }
+            return bucket;
+        }
+
+        /// Return the total number of measurements.
+        std::uint64_t get_count() const noexcept
+        {
+            std::uint64_t sum = 0;
+            for (const auto count : counts)
+                sum += count;
+            return sum;
+        }
+
+        /**
+         * Return an upper bound for the given quantile of the measured durations.
+         *
+         * \param quantile  A number between 0 and 1 (e.g. 0.99 for the 99th percentile)
+         *
+         * \returns the upper bound of the bucket that contains the quantile, or
+         *          Duration::zero() if there are no measurements.
+         */
+        Duration get_quantile(double quantile) const noexcept
+        {
+            const auto total = get_count();
+            if (total == 0)
+                return Duration::zero();
+
+            const auto rank = static_cast<std::uint64_t>(
+                std::max(0.0, std::min(1.0, quantile)) * static_cast<double>(total - 1));
+
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i != num_buckets; ++i)
+            {
+                sum += counts[i];
+                if (sum > rank)
+                    return get_upper_bound(i);
+            }
+            return Duration::max();
+        }
+    };
+
+    /**
+     * A snapshot of the runtime metrics of a ThreadPool (see get_metrics()).
+     *
+     * All values are accumulated since the creation of the pool.
+     */
+    struct Metrics
+    {
+        /**
+         * Time between the moment a task could have been started (when it was added or
+         * when its start time had come) and the moment it was actually started.
+         */
+        DurationHistogram queue_latency;
+
+        /// Execution time of the tasks.
+        DurationHistogram execution_time;
+
+        /// Number of tasks that have finished without throwing an exception.
+        std::uint64_t num_completed{ 0 };
+
+        /// Number of tasks that have finished by throwing an exception.
+        std::uint64_t num_failed{ 0 };
+
+        /// Number of tasks that have been removed from the queue before being started.
+        std::uint64_t num_canceled{ 0 };
+
+        /// Highest number of pending tasks that has been observed.
+        std::size_t max_pending{ 0 };
+
+        /// Number of times a sleeping worker thread was woken up for new tasks.
+        std::uint64_t num_wakeups{ 0 };
+
+        /**
+         * Number of wake-ups that were not necessary because no worker thread was
+         * sleeping or all sleeping ones had already been woken up.
+         */
+        std::uint64_t num_wakeups_avoided{ 0 };
+
+        /**
+         * Number of times an idle worker thread found a new task while polling, so that
+         * it did not have to go to sleep (see Options::spin_time).
+         */
+        std::uint64_t num_spin_hits{ 0 };
+
+        /**
+         * For each worker thread, the fraction of the lifetime of the pool that it has
+         * spent executing tasks (between 0 and 1).
+         */
+        std::vector<double> thread_busy_ratios;
+    };
+
+    /// A record of one execution of a task (see get_trace()).
+    struct TraceEvent
+    {
+        /// ID of the task.
+        TaskId task_id{ 0 };
+
+        /// Name of the task (empty for detached and unnamed tasks).
+        std::string name;
+
+        /// ID of the worker thread that has executed the task.
+        ThreadId thread_id{ 0 };
+
+        /// Time at which the task was put into the queue.
+        SteadyTimePoint enqueue_time{};
+
+        /// Time at which the execution started.
+        SteadyTimePoint start_time{};
+
+        /// Time at which the execution finished.
+        SteadyTimePoint end_time{};
+    };
+
+    /**
+     * Destruct the ThreadPool and join all threads.
+     *
+     * This destructor blocks until all threads have terminated. Work that has not yet
+     * been started in one of the threads gets canceled, but work that has already been
+     * assigned to a thread continues to be executed until it completes.
+     */
+    ~ThreadPool();
+
+    /**
+     * Enqueue a task.
+     *
+     * There are multiple overloads of this function for variations of the arguments:
+     *
+     * \param fct   A function object or function pointer to be executed. This function
+     *              can have an arbitrary return type and may either take no arguments
+     *              (`T fct()`) or a reference to the ThreadPool by which it gets
+     *              executed (`T fct(ThreadPool&)`). In both cases, it may take a
+     *              StopToken as an additional last argument to support
+     *              TaskHandle::request_stop().
+     * \param priority  Optional priority of the task (TaskPriority::normal if omitted).
+     *              Among the tasks that are ready to be started, those with a higher
+     *              priority are started first. A delayed task competes with the others
+     *              only once its start time has come.
+     * \param start_time  Earliest time point at which the task is to be started. This can
+     *              be a time point of the system clock (TimePoint) or of the steady
+     *              clock (SteadyTimePoint). The default-constructed time point means
+     *              "as soon as possible".
+     * \param name  Optional name for the task (mainly for debugging)
+     *
+     * \returns a TaskHandle that can be used for inquiries about the state of the task
+     *          and to retrieve its return value.
+     * \exception std::runtime_error is thrown if the queue is full.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(2); // Create a pool with 2 threads
+     *
+     * // A simple task that does not interact with the pool
+     * pool->add_task([]() { std::cout << "Task 1\n"; });
+     *
+     * // A task that schedules another task to start two seconds later
+     * pool->add_task(
+     *     [](ThreadPool& pool)
+     *     {
+     *         std::cout << "Task 2\n";
+     *         pool.add_task([]() { std::cout << "Task 3\n"; }, 2s);
+     *     });
+     *
+     * // A task with a name
+     * pool->add_task([]() { std::cout << "Task 4\n"; }, "Task 4");
+     *
+     * // A task that starts at a time point of the steady clock
+     * pool->add_task([]() { std::cout << "Task 5\n"; },
+     *     std::chrono::steady_clock::now() + 100ms);
+     *
+     * // A task that is started before all tasks with normal or low priority
+     * pool->add_task([]() { std::cout << "Task 6\n"; }, TaskPriority::high, "Task 6");
+     * \endcode
+     *
+     * \since GUL version 2.12.1, add_task() unconditionally accepts mutable function
+     *        objects
+     */
+    template <typename Function>
+    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
+    add_task(Function fct, TimePoint start_time = {}, std::string name = {})
+    {
+        static_assert(
+            std::is_invocable<Function, ThreadPool&>::value
+            || std::is_invocable<Function>::value,
+            "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
+
+        return add_task(std::move(fct), to_steady_time_point(start_time), std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function, ThreadPool&>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
+    add_task(Function fct, SteadyTimePoint start_time, std::string name = {})
+    {
+        return add_task(
+            std::move(fct), TaskPriority::normal, start_time, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function>>
+    add_task(Function fct, TimePoint start_time = {}, std::string name = {})
+    {
+        return add_task(
+            [f = std::move(fct)](ThreadPool&) mutable { return f(); },
+            start_time, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function>>
+    add_task(Function fct, SteadyTimePoint start_time, std::string name = {})
+    {
+        return add_task(
+            [f = std::move(fct)](ThreadPool&) mutable { return f(); },
+            start_time, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function, ThreadPool&>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
+    add_task(Function fct, Duration delay_before_start, std::string name = {})
+    {
+        return add_task(std::move(fct),
+            std::chrono::steady_clock::now() + delay_before_start, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function>>
+    add_task(Function fct, Duration delay_before_start, std::string name = {})
+    {
+        return add_task(std::move(fct),
+            std::chrono::steady_clock::now() + delay_before_start, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function, ThreadPool&>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
+    add_task(Function fct, std::string name)
+    {
+        return add_task(std::move(fct), SteadyTimePoint{}, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
+    TaskHandle<std::invoke_result_t<Function>>
+    add_task(Function fct, std::string name)
+    {
+        return add_task(std::move(fct), SteadyTimePoint{}, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<detail::takes_stop_token_v<Function>, bool> = true>
+    auto add_task(Function fct, SteadyTimePoint start_time = {}, std::string name = {})
+    {
+        return add_task(
+            std::move(fct), TaskPriority::normal, start_time, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<detail::takes_stop_token_v<Function>, bool> = true>
+    auto add_task(Function fct, TimePoint start_time, std::string name = {})
+    {
+        return add_task(std::move(fct), TaskPriority::normal,
+            to_steady_time_point(start_time), std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<detail::takes_stop_token_v<Function>, bool> = true>
+    auto add_task(Function fct, Duration delay_before_start, std::string name = {})
+    {
+        return add_task(std::move(fct), TaskPriority::normal,
+            std::chrono::steady_clock::now() + delay_before_start, std::move(name));
+    }
+
+    template <typename Function,
+        std::enable_if_t<detail::takes_stop_token_v<Function>, bool> = true>
+    auto add_task(Function fct, std::string name)
+    {
+        return add_task(
+            std::move(fct), TaskPriority::normal, SteadyTimePoint{}, std::move(name));
+    }
+
+    template <typename Function>
+    auto add_task(Function fct, TaskPriority priority, SteadyTimePoint start_time,
+        std::string name = {})
+    {
+        auto prepared = prepare_task(std::move(fct), start_time, priority, std::move(name));
+        const TaskId id = enqueue_task(std::move(prepared.task_));
+
+        return make_handle(id, prepared);
+    }
+
+    template <typename Function>
+    auto add_task(Function fct, TaskPriority priority, TimePoint start_time,
+        std::string name = {})
+    {
+        return add_task(std::move(fct), priority, to_steady_time_point(start_time),
+            std::move(name));
+    }
+
+    template <typename Function>
+    auto add_task(Function fct, TaskPriority priority, Duration delay_before_start,
+        std::string name = {})
+    {
+        return add_task(std::move(fct), priority,
+            std::chrono::steady_clock::now() + delay_before_start, std::move(name));
+    }
+
+    template <typename Function>
+    auto add_task(Function fct, TaskPriority priority, std::string name = {})
+    {
+        return add_task(std::move(fct), priority, SteadyTimePoint{}, std::move(name));
+    }
+
+    /**
+     * Enqueue a batch of tasks.
+     *
+     * This is equivalent to calling add_task() for each element of the range, but more
+     * efficient: All tasks are added with a single lock acquisition, the capacity of the
+     * queue is checked once for the whole batch, and only as many idle worker threads are
+     * woken up as there are new tasks.
+     *
+     * There are two overloads of this function:
+     * - `add_tasks(first, last, name)` enqueues a copy of each function object in the
+     *   range [first, last).
+     * - `add_tasks(count, generator, name)` enqueues the function objects returned by
+     *   `generator(0)`, `generator(1)`, ..., `generator(count - 1)`.
+     *
+     * All function objects must have the same type. As with add_task(), they can have an
+     * arbitrary return type and may either take no arguments or a reference to the
+     * ThreadPool.
+     *
+     * \param first, last  Range of function objects (forward iterators)
+     * \param count        Number of tasks to generate
+     * \param generator    A function object `F generator(std::size_t index)` that returns
+     *                     the function object for the task with the given index
+     * \param name         Optional name given to all tasks (mainly for debugging)
+     *
+     * \returns a vector of TaskHandles, one for each task in the order of the input.
+     * \exception std::runtime_error is thrown if the queue does not have room for all
+     *            tasks. In this case, no task is added.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(4);
+     * auto handles = pool->add_tasks(100,
+     *     [](std::size_t i) { return [i]() { return i * i; }; });
+     * std::size_t sum = 0;
+     * for (auto& handle : handles)
+     *     sum += handle.get_result();
+     * \endcode
+     */
+    template <typename Generator>
+    auto add_tasks(std::size_t count, Generator generator, std::string name = {})
+    {
+        using Function = std::decay_t<std::invoke_result_t<Generator&, std::size_t>>;
+
+        static_assert(
+            std::is_invocable<Function, ThreadPool&>::value
+            || std::is_invocable<Function>::value,
+            "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
+
+        using PoolFunction = decltype(with_pool_argument(std::declval<Function>()));
+        using Result = std::invoke_result_t<PoolFunction&, ThreadPool&>;
+        using PackagedTask = std::packaged_task<Result(ThreadPool&)>;
+
+        std::vector<TaskHandle<Result>> handles;
+        if (count == 0)
+            return handles;
+
+        // Prepare everything that needs allocations before touching the queue
+        std::vector<Task> tasks;
+        std::vector<std::future<Result>> futures;
+        tasks.reserve(count);
+        futures.reserve(count);
+
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            auto named_task_ptr = std::make_unique<NamedTaskImpl<PackagedTask>>(
+                PackagedTask{ track_exceptions(with_pool_argument(generator(i))) }, name);
+            futures.push_back(named_task_ptr->fct_.get_future());
+            tasks.emplace_back(0, std::move(named_task_ptr), SteadyTimePoint{});
+        }
+
+        const TaskId first_id = enqueue_tasks(tasks);
+
+        auto self = shared_from_this();
+        handles.reserve(count);
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            handles.push_back(
+                TaskHandle<Result>{ first_id + i, std::move(futures[i]), self });
+        }
+
+        return handles;
+    }
+
+    template <typename ForwardIt>
+    auto add_tasks(ForwardIt first, ForwardIt last, std::string name = {})
+    {
+        const auto count = static_cast<std::size_t>(std::distance(first, last));
+
+        return add_tasks(count,
+            [&first](std::size_t) { return *first++; }, std::move(name));
+    }
+
+    /**
+     * Enqueue all tasks of a TaskGraph.
+     *
+     * Tasks without dependencies are ready to be started immediately. All other tasks
+     * stay pending until all of their dependencies have finished (successfully, by
+     * throwing an exception, or by being canceled). The capacity of the queue is checked
+     * once for the whole graph: Either all tasks are enqueued or none.
+     *
+     * \param graph  The graph of tasks to be added
+     *
+     * \returns a vector of TaskHandles, indexed by the node IDs of the graph.
+     * \exception std::runtime_error is thrown if the queue does not have room for all
+     *            tasks.
+     */
+    GUL_EXPORT
+    std::vector<TaskHandle<void>> add_task_graph(TaskGraph graph);
+
+    /**
+     * Try to enqueue a task without throwing if the queue is full.
+     *
+     * This function behaves like `add_task(fct, name)`, but it returns an empty optional
+     * instead of throwing an exception if the queue has reached its capacity. It is meant
+     * for producers that want to handle a full queue themselves (e.g. by dropping data).
+     *
+     * \param fct   A function object or function pointer to be executed (see add_task())
+     * \param name  Optional name for the task (mainly for debugging)
+     *
+     * \returns a TaskHandle for the new task, or an empty optional if the queue is full.
+     *
+     * \see add_task_wait(), add_task_wait_for()
+     */
+    template <typename Function>
+    auto try_add_task(Function fct, std::string name = {})
+    {
+        auto prepared = prepare_task(
+            std::move(fct), SteadyTimePoint{}, TaskPriority::normal, std::move(name));
+
+        TaskId id;
+        using Handle = decltype(make_handle(id, prepared));
+
+        if (not try_enqueue_task(prepared.task_, id))
+            return std::optional<Handle>{};
+
+        return std::optional<Handle>{ make_handle(id, prepared) };
+    }
+
+    /**
+     * Enqueue a task, waiting for space in the queue if it is full.
+     *
+     * This function behaves like `add_task(fct, name)`, but if the queue has reached its
+     * capacity, it blocks until a pending task has been started or canceled instead of
+     * throwing an exception. The calling thread sleeps on a condition variable in the
+     * meantime, so producer threads are throttled to the rate at which the pool processes
+     * tasks.
+     *
+     * \param fct   A function object or function pointer to be executed (see add_task())
+     * \param name  Optional name for the task (mainly for debugging)
+     *
+     * \returns a TaskHandle that can be used for inquiries about the state of the task
+     *          and to retrieve its return value.
+     *
+     * \note Calling this function from a worker thread of the same pool can deadlock if
+     *       all worker threads end up waiting for space in the queue. Use try_add_task()
+     *       or add_task_wait_for() there.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(4, 100);
+     * while (auto sample = acquire_sample()) // Acquisition is throttled by the pool
+     *     pool->add_task_wait([s = *sample]() { process(s); });
+     * \endcode
+     */
+    template <typename Function>
+    auto add_task_wait(Function fct, std::string name = {})
+    {
+        auto prepared = prepare_task(
+            std::move(fct), SteadyTimePoint{}, TaskPriority::normal, std::move(name));
+
+        TaskId id;
+        enqueue_task_wait(prepared.task_, id, SteadyTimePoint::max());
+
+        return make_handle(id, prepared);
+    }
+
+    /**
+     * Enqueue a task, waiting for space in the queue for at most the given time.
+     *
+     * This function behaves like add_task_wait(), but gives up if the queue is still full
+     * after the specified timeout.
+     *
+     * \param fct      A function object or function pointer to be executed (see
+     *                 add_task())
+     * \param timeout  Maximum time to wait for space in the queue
+     * \param name     Optional name for the task (mainly for debugging)
+     *
+     * \returns a TaskHandle for the new task, or an empty optional if the queue was full
+     *          for the entire timeout.
+     */
+    template <typename Function>
+    auto add_task_wait_for(Function fct, Duration timeout, std::string name = {})
+    {
+        const auto deadline = detail::get_deadline(timeout);
+
+        auto prepared = prepare_task(
+            std::move(fct), SteadyTimePoint{}, TaskPriority::normal, std::move(name));
+
+        TaskId id;
+        using Handle = decltype(make_handle(id, prepared));
+
+        if (not enqueue_task_wait(prepared.task_, id, deadline))
+            return std::optional<Handle>{};
+
+        return std::optional<Handle>{ make_handle(id, prepared) };
+    }
+
+    /**
+     * Enqueue a task without a handle ("fire and forget").
+     *
+     * Detached tasks have no name, no result, and cannot be canceled individually. In
+     * exchange, adding them is cheaper than with add_task(): Function objects up to the
+     * size of a few pointers (e.g. a lambda capturing a few references) are stored
+     * directly in the pool's queue. Once the queue has grown to the needed size, adding
+     * such a task to the shared queue does not allocate any memory.
+     *
+     * \param fct   A function object or function pointer to be executed. Its return
+     *              value is ignored. The function may either take no arguments
+     *              (`void fct()`) or a reference to the ThreadPool by which it gets
+     *              executed (`void fct(ThreadPool&)`). Exceptions thrown by the function
+     *              are ignored.
+     * \param start_time  Earliest time point at which the task is to be started. The
+     *              default-constructed time point means "as soon as possible".
+     *
+     * \exception std::runtime_error is thrown if the queue is full.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(4);
+     * std::atomic<int> counter{ 0 };
+     * for (int i = 0; i != 1000; ++i)
+     *     pool->add_detached_task([&counter]() { ++counter; });
+     * \endcode
+     */
+    template <typename Function>
+    void add_detached_task(Function fct, SteadyTimePoint start_time = {})
+    {
+        static_assert(
+            std::is_invocable<Function, ThreadPool&>::value
+            || std::is_invocable<Function>::value,
+            "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
+
+        if constexpr (std::is_invocable<Function, ThreadPool&>::value)
+        {
+            enqueue_task(
+                Task{ detail::InlineTaskFunction{ std::move(fct) }, start_time });
+        }
+        else
+        {
+            enqueue_task(Task{
+                detail::InlineTaskFunction{
+                    [f = std::move(fct)](ThreadPool&) mutable { f(); } },
+                start_time });
+        }
+    }
+
+    template <typename Function>
+    void add_detached_task(Function fct, Duration delay_before_start)
+    {
+        add_detached_task(std::move(fct),
+            std::chrono::steady_clock::now() + delay_before_start);
+    }
+
+    /**
+     * Enqueue a task that is executed periodically.
+     *
+     * The task is first started after the given phase (delay) and then repeatedly with
+     * the given period until it is canceled via its handle or the pool is destroyed. One
+     * task object is reused for all executions. A periodic task occupies one place in the
+     * queue of pending tasks while it waits for its next start time.
+     *
+     * \param fct     A function object or function pointer to be executed. Its return
+     *                value is ignored. The function may either take no arguments
+     *                (`void fct()`) or a reference to the ThreadPool by which it gets
+     *                executed (`void fct(ThreadPool&)`). If it throws an exception, the
+     *                exception is ignored and the task is rescheduled as usual.
+     * \param period  Time between two executions (must be positive)
+     * \param phase   Delay before the first execution
+     * \param mode    Determines whether the task is scheduled at a fixed rate or with a
+     *                fixed delay between the end of one execution and the start of the
+     *                next one (see PeriodicTaskMode)
+     * \param name    Optional name for the task (mainly for debugging)
+     *
+     * \returns a PeriodicTaskHandle that can be used to stop the task and to inquire
+     *          about the number of executions and overruns.
+     * \exception std::invalid_argument is thrown if the period is not positive.
+     * \exception std::runtime_error is thrown if the queue is full.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(2);
+     *
+     * // Poll a device every 100 ms, starting 50 ms from now
+     * auto task = pool->add_periodic_task([]() { poll_device(); }, 100ms, 50ms);
+     * ...
+     * task.cancel();
+     * \endcode
+     */
+    template <typename Function>
+    PeriodicTaskHandle
+    add_periodic_task(Function fct, Duration period, Duration phase = Duration::zero(),
+        PeriodicTaskMode mode = PeriodicTaskMode::fixed_rate, std::string name = {})
+    {
+        static_assert(
+            std::is_invocable<Function, ThreadPool&>::value
+            || std::is_invocable<Function>::value,
+            "Invalid function signature: Must be T fct() or T fct(ThreadPool&)");
+
+        if (period <= Duration::zero())
+            throw std::invalid_argument(cat("Illegal period for periodic task: ",
+                std::chrono::duration<double>(period).count(), " s"));
+
+        auto state = std::make_shared<detail::PeriodicTaskState>();
+
+        auto named_task_ptr = std::make_unique<PeriodicTaskImpl<Function>>(
+            std::move(fct), std::chrono::duration_cast<SteadyTimePoint::duration>(period),
+            mode, state, std::move(name));
+
+        const TaskId id = enqueue_task(Task{ 0, std::move(named_task_ptr),
+            std::chrono::steady_clock::now() + std::max(Duration::zero(), phase) });
+
+        return PeriodicTaskHandle{ id, std::move(state), shared_from_this() };
+    }
+
+    template <typename Function>
+    PeriodicTaskHandle
+    add_periodic_task(Function fct, Duration period, std::string name)
+    {
+        return add_periodic_task(std::move(fct), period, Duration::zero(),
+            PeriodicTaskMode::fixed_rate, std::move(name));
+    }
+
+    /**
+     * Remove all pending tasks from the queue.
+     *
+     * This call removes all tasks that have not yet been started from the queue. It has
+     * no impact on tasks that are currently being executed.
+     *
+     * \returns the number of tasks that were removed.
+     */
+    GUL_EXPORT
+    std::size_t cancel_pending_tasks();
+
+    /// Return the maximum number of pending tasks that can be queued.
+    GUL_EXPORT
+    std::size_t capacity() const noexcept { return capacity_; }
+
+    /// Return the number of pending tasks.
+    GUL_EXPORT
+    std::size_t count_pending() const;
+
+    /**
+     * Return the number of threads in the pool.
+     *
+     * For a dynamically scaling pool (see Options::max_num_threads), this is the current
+     * number of threads.
+     */
+    GUL_EXPORT
+    std::size_t count_threads() const noexcept;
+
+    /// Return a vector with the names of the tasks that are waiting to be executed.
+    GUL_EXPORT
+    std::vector<std::string> get_pending_task_names() const;
+
+    /// Return a vector with the names of the tasks that are currently running.
+    GUL_EXPORT
+    std::vector<std::string> get_running_task_names() const;
+
+    /**
+     * Return a snapshot of the runtime metrics of the pool.
+     *
+     * The snapshot is assembled from atomic counters without locking any of the queues,
+     * so it can be taken at any time without disturbing the workers. Counters are read
+     * one by one, however, so a snapshot taken while tasks are running may be slightly
+     * inconsistent.
+     *
+     * \exception std::logic_error is thrown if the pool was not created with
+     *            Options::collect_metrics enabled.
+     */
+    GUL_EXPORT
+    Metrics get_metrics() const;
+
+    /**
+     * Return the most recent task executions recorded by the worker threads, ordered by
+     * their start time.
+     *
+     * Each worker thread keeps up to Options::trace_capacity events. Recording an event
+     * only touches the buffer of the executing thread, so workers never wait for each
+     * other.
+     *
+     * \exception std::logic_error is thrown if the pool was not created with a nonzero
+     *            Options::trace_capacity.
+     *
+     * \see write_chrome_trace()
+     */
+    GUL_EXPORT
+    std::vector<TraceEvent> get_trace() const;
+
+    /**
+     * Return the thread pool ID of the current thread.
+     *
+     * \returns a thread ID in the range [0, n), where n is the maximum number of
+     *          threads of the pool (see Options::max_num_threads).
+     *
+     * \exception std::runtime_error is thrown if this function is called from a thread
+     *            that is not part of the pool.
+     *
+     * \since GUL version 2.13
+     */
+    GUL_EXPORT
+    ThreadId get_thread_id() const;
+
+    /**
+     * Return the CPU to which a worker thread is pinned.
+     *
+     * \param thread_id  ID of the worker thread (see get_thread_id())
+     *
+     * \returns the number of the CPU, or -1 if the thread is not pinned. This is the case
+     *          if Options::pin_threads is not set, if pinning is not supported on this
+     *          platform or has failed, or if no thread is running with this ID.
+     *
+     * \exception std::out_of_range is thrown if the thread ID is not in the range of
+     *            thread IDs of the pool.
+     */
+    GUL_EXPORT
+    int get_thread_cpu(ThreadId thread_id) const;
+
+    /// Determine whether the queue for pending tasks is full (at capacity).
+    GUL_EXPORT
+    bool is_full() const noexcept;
+
+    /**
+     * Return true if the pool has neither pending tasks nor tasks that are currently
+     * being executed.
+     */
+    GUL_EXPORT
+    bool is_idle() const;
+
+    /// Determine whether the thread pool has been requested to shut down.
+    GUL_EXPORT
+    bool is_shutdown_requested() const;
+
+    /**
+     * Stop the worker threads of the pool, either after executing or after canceling the
+     * pending tasks.
+     *
+     * With ShutdownMode::drain, the function first waits until the pool is idle. Tasks
+     * that running tasks add in the meantime are executed, too. With
+     * ShutdownMode::discard, all pending tasks are canceled right away and the function
+     * only waits for the tasks that are already running.
+     *
+     * Once shutdown has been requested, the pool does not accept new tasks anymore:
+     * add_task() and the other functions for adding tasks throw a std::runtime_error,
+     * try_add_task() returns an empty optional. Tasks that are still pending when the
+     * worker threads are stopped (e.g. after a timeout) are canceled. If the pool has
+     * become idle within the timeout, the worker threads are joined before the function
+     * returns. Otherwise, they terminate after finishing their current task and are
+     * joined by the destructor.
+     *
+     * Periodic tasks are not rescheduled after the shutdown request. A pool with a
+     * periodic task does not become idle, though, so the task should be canceled before
+     * draining the pool.
+     *
+     * \param mode     What to do with the pending tasks
+     * \param timeout  Maximum time to wait for the tasks to finish
+     *
+     * \returns true if all threads have been stopped within the timeout, false otherwise.
+     *
+     * \exception std::logic_error is thrown if the function is called from a worker
+     *            thread of the pool.
+     *
+     * \code{.cpp}
+     * auto pool = make_thread_pool(4);
+     * // ...
+     * if (not pool->shutdown(ShutdownMode::drain, 5s))
+     *     std::cerr << "Tasks are still running after 5 seconds\n";
+     * \endcode
+     */
+    GUL_EXPORT
+    bool shutdown(ShutdownMode mode = ShutdownMode::drain,
+        Duration timeout = Duration::max());
+
+    /**
+     * Write the recorded task executions (see get_trace()) to a stream in the JSON trace
+     * event format.
+     *
+     * The output can be loaded into Perfetto (https://ui.perfetto.dev) or the Chrome
+     * trace viewer (chrome://tracing), which show a timeline of the tasks on each worker
+     * thread. Time stamps are given in microseconds since the creation of the pool.
+     *
+     * \exception std::logic_error is thrown if tracing is not enabled for this pool.
+     *
+     * \code{.cpp}
+     * ThreadPool::Options options;
+     * options.num_threads = 4;
+     * options.trace_capacity = 10'000;
+     * auto pool = make_thread_pool(options);
+     * // ...
+     * std::ofstream file("pool_trace.json");
+     * pool->write_chrome_trace(file);
+     * \endcode
+     */
+    GUL_EXPORT
+    void write_chrome_trace(std::ostream& out) const;
+
+    /**
+     * Wait until the pool has neither pending nor running tasks.
+     *
+     * The calling thread sleeps on a condition variable until the last task has
+     * finished; this is more efficient and responsive than polling is_idle(). Note that a
+     * pool with a periodic task never becomes idle until the task is canceled.
+     *
+     * \param timeout  Maximum time to wait
+     *
+     * \returns true if the pool is idle, false if the timeout has expired.
+     *
+     * \exception std::logic_error is thrown if the function is called from a worker
+     *            thread of the pool (which would wait for its own task).
+     */
+    GUL_EXPORT
+    bool wait_idle(Duration timeout = Duration::max()) const;
+
+    /**
+     * Create a thread pool with the desired number of threads and the specified capacity
+     * for enqueuing tasks.
+     *
+     * The thread pool is allocated in a shared pointer, which is necessary so that task
+     * handles can access the pool safely. A ThreadPool cannot be constructed directly.
+     *
+     * \returns a shared pointer to the created ThreadPool object.
+     */
+    GUL_EXPORT
+    static std::shared_ptr<ThreadPool> make_shared(
+        std::size_t num_threads, std::size_t capacity = default_capacity);
+
+    /**
+     * Create a thread pool with the given options.
+     *
+     * \returns a shared pointer to the created ThreadPool object.
+     */
+    GUL_EXPORT
+    static std::shared_ptr<ThreadPool> make_shared(const Options& options);
+
+private:
+    /**
+     * An enum describing the internal state of a task on the ThreadPool.
+     *
+     * This enum just describes if the task is pending, running, or neither. The pool has
+     * no further knowledge about the task, but a TaskHandle can additionally determine if
+     * a task has completed or been canceled.
+     */
+    enum class InternalTaskState
+    {
+        /// The task is waiting to be started
+        pending = static_cast<int>(TaskState::pending),
+        /// The task is currently being executed
+        running = static_cast<int>(TaskState::running),
+        /// The thread pool has no knowledge about this task
+        unknown
+    };
+
+    struct NamedTask
+    {
+        NamedTask(std::string name, bool is_periodic = false)
+        : name_{ std::move(name) }
+        , is_periodic_{ is_periodic }
+        {}
+
+        virtual ~NamedTask() = default;
+        virtual void operator()(ThreadPool& pool) = 0;
+
+        /**
+         * Determine the next start time of a periodic task after an execution.
+         *
+         * This function is only called for periodic tasks and with mutex_ locked.
+         *
+         * \param start_time  The time for which the last execution was scheduled; it is
+         *                    replaced by the next start time.
+         *
+         * \returns true if the task is to be executed again, false otherwise.
+         */
+        virtual bool reschedule(SteadyTimePoint& /* start_time */) { return false; }
+
+        std::string name_;
+        bool is_periodic_{ false };
+    };
+
+    template <typename FunctionType>
+    struct NamedTaskImpl : public NamedTask
     {
-        return add_task(std::move(fct),
-            std::chrono::system_clock::now() + delay_before_start, std::move(name));
-    }
+    public:
+        NamedTaskImpl(FunctionType fct, std::string name)
+        : NamedTask{ std::move(name) }
+        , fct_{ std::move(fct) }
+        {}
 
-    template <typename Function,
-        std::enable_if_t<std::is_invocable<Function, ThreadPool&>::value, bool> = true>
-    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
-    add_task(Function fct, std::string name)
+        void operator()(ThreadPool& pool) override { fct_(pool); }
+
+        FunctionType fct_;
+    };
+
+    template <typename FunctionType>
+    struct PeriodicTaskImpl : public NamedTask
     {
-        return add_task(std::move(fct), TimePoint{}, std::move(name));
-    }
+    public:
+        PeriodicTaskImpl(FunctionType fct, SteadyTimePoint::duration period,
+            PeriodicTaskMode mode, std::shared_ptr<detail::PeriodicTaskState> state,
+            std::string name)
+        : NamedTask{ std::move(name), true }
+        , fct_{ std::move(fct) }
+        , period_{ period }
+        , mode_{ mode }
+        , state_{ std::move(state) }
+        {}
 
-    template <typename Function,
-        std::enable_if_t<std::is_invocable<Function>::value, bool> = true>
-    TaskHandle<std::invoke_result_t<Function>>
-    add_task(Function fct, std::string name)
+        void operator()(ThreadPool& pool) override
+        {
+            try
+            {
+                if constexpr (std::is_invocable<FunctionType, ThreadPool&>::value)
+                    fct_(pool);
+                else
+                    fct_();
+            }
+            catch (...)
+            {
+                // Exceptions from periodic tasks are ignored, the task keeps running.
+                pool.count_task_exception();
+            }
+
+            ++state_->num_runs_;
+        }
+
+        bool reschedule(SteadyTimePoint& start_time) override
+        {
+            if (state_->canceled_)
+                return false;
+
+            const auto now = std::chrono::steady_clock::now();
+
+            if (mode_ == PeriodicTaskMode::fixed_delay)
+            {
+                start_time = now + period_;
+                return true;
+            }
+
+            start_time += period_;
+
+            if (start_time <= now)
+            {
+                // Skip all start times that have already passed
+                const auto num_missed = (now - start_time) / period_ + 1;
+                state_->num_overruns_ += static_cast<std::uint64_t>(num_missed);
+                start_time += num_missed * period_;
+            }
+
+            return true;
+        }
+
+        FunctionType fct_;
+        SteadyTimePoint::duration period_;
+        PeriodicTaskMode mode_;
+        std::shared_ptr<detail::PeriodicTaskState> state_;
+    };
+
+    /**
+     * A task in one of the queues. It either holds a NamedTask (for tasks with a handle)
+     * or a detached function object stored inline.
+     */
+    struct Task
     {
-        return add_task(std::move(fct), TimePoint{}, std::move(name));
-    }
+        TaskId id_{};
+        std::unique_ptr<NamedTask> named_task_;
+        detail::InlineTaskFunction detached_fct_;
+        SteadyTimePoint start_time_{}; // When the task is to be started (no earlier)
+        TaskPriority priority_{ TaskPriority::normal };
+        SteadyTimePoint enqueue_time_{}; // When the task was queued (if needed)
+
+        Task() = default;
+
+        Task(TaskId task_id, std::unique_ptr<NamedTask> named_task,
+            SteadyTimePoint start_time, TaskPriority priority = TaskPriority::normal)
+        : id_{ task_id }
+        , named_task_{ std::move(named_task) }
+        , start_time_{ start_time }
+        , priority_{ priority }
+        {}
+
+        Task(detail::InlineTaskFunction fct, SteadyTimePoint start_time)
+        : detached_fct_{ std::move(fct) }
+        , start_time_{ start_time }
+        {}
+
+        /// Determine whether this is a detached task (without name and handle).
+        bool is_detached() const noexcept { return named_task_ == nullptr; }
+
+        /// Determine whether this is a periodic task.
+        bool is_periodic() const noexcept
+        {
+            return named_task_ != nullptr && named_task_->is_periodic_;
+        }
+
+        /**
+         * Return a pointer to the name of the task (null for detached tasks). The name
+         * does not move in memory when the Task object is moved.
+         */
+        const std::string* get_name() const noexcept
+        {
+            return named_task_ ? &named_task_->name_ : nullptr;
+        }
+
+        /// Execute the task.
+        void operator()(ThreadPool& pool)
+        {
+            if (named_task_)
+                (*named_task_)(pool);
+            else
+                detached_fct_(pool);
+        }
+    };
+
+    /// A task that has not been enqueued yet, together with the future for its result.
+    template <typename Result>
+    struct PreparedTask
+    {
+        Task task_;
+        std::future<Result> future_;
+        std::shared_ptr<std::atomic<bool>> stop_state_;
+    };
+
+    /// Index of an entry in task_slots_.
+    using SlotIndex = std::size_t;
+
+    /// A marker for "no slot" (end of a list, not in the heap).
+    constexpr static SlotIndex no_slot{ std::numeric_limits<SlotIndex>::max() };
 
     /**
-     * Remove all pending tasks from the queue.
+     * A slot for a task in the shared queue.
      *
-     * This call removes all tasks that have not yet been started from the queue. It has
-     * no impact on tasks that are currently being executed.
+     * Ready tasks are kept in a doubly linked FIFO list threaded through the slots, tasks
+     * with a start time in the future in a binary min-heap. A slot is in exactly one of
+     * these structures, so a task can be removed in constant or logarithmic time once its
+     * slot is known.
+     */
+    struct TaskSlot
+    {
+        Task task_;
+        SlotIndex prev_{ no_slot }; // Previous slot in the FIFO list of ready tasks
+        SlotIndex next_{ no_slot }; // Next slot in the FIFO list of ready tasks
+        std::size_t heap_pos_{ no_slot }; // Position in scheduled_tasks_ (or no_slot)
+        SteadyTimePoint ready_since_{}; // When the task became ready (for aging)
+    };
+
+    /// Number of different task priorities.
+    constexpr static std::size_t num_priorities{ 3 };
+
+    /// First and last slot of a FIFO list of tasks that are ready to be started.
+    struct ReadyList
+    {
+        SlotIndex head_{ no_slot };
+        SlotIndex tail_{ no_slot };
+    };
+
+    /**
+     * Per-thread data.
      *
-     * \returns the number of tasks that were removed.
+     * Each worker records the task it is currently running. The slot refers to the name
+     * of the task instead of copying it, so it has to be cleared before the task is
+     * destroyed or handed back to the queue. A task whose name has been released this way
+     * is still running, but it is no longer listed by get_running_task_names().
+     *
+     * In work-stealing mode, a worker also has a local task queue. It can be pushed to
+     * only by the owning thread, but any thread may pop tasks from it. The running task
+     * is recorded under the same lock so that a task never appears to be neither pending
+     * nor running while it is handed over.
      */
-    GUL_EXPORT
-    std::size_t cancel_pending_tasks();
+    struct Worker
+    {
+        std::mutex mutex_; // Protects the following variables
+        std::deque<Task> local_tasks_;
+        TaskId running_task_id_{ 0 };
+        const std::string* running_task_name_{ nullptr };
+        bool is_running_task_{ false };
+        bool is_finishing_task_{ false };
+
+        /// Record the given task as running (mutex_ must be locked).
+        void start_task(const Task& task) noexcept
+        {
+            running_task_id_ = task.id_;
+            running_task_name_ = task.get_name();
+            is_running_task_ = true;
+            is_finishing_task_ = false;
+        }
 
-    /// Return the maximum number of pending tasks that can be queued.
-    GUL_EXPORT
-    std::size_t capacity() const noexcept { return capacity_; }
+        /**
+         * Record that the running task has been executed and is about to be destroyed
+         * (mutex_ must be locked). The name of the task is dropped because it goes away
+         * with the task.
+         */
+        void release_task_name() noexcept
+        {
+            running_task_name_ = nullptr;
+            is_finishing_task_ = true;
+        }
 
-    /// Return the number of pending tasks.
-    GUL_EXPORT
-    std::size_t count_pending() const;
+        /// Record that no task is running (mutex_ must be locked).
+        void finish_task() noexcept
+        {
+            running_task_name_ = nullptr;
+            is_running_task_ = false;
+            is_finishing_task_ = false;
+        }
+    };
 
-    /// Return the number of threads in the pool.
-    GUL_EXPORT
-    std::size_t count_threads() const noexcept;
+    /**
+     * Metrics recorded by a single worker thread. Only the owning thread writes to these
+     * counters, all other threads may read them at any time.
+     */
+    struct alignas(64) ThreadMetrics
+    {
+        std::array<std::atomic<std::uint64_t>, DurationHistogram::num_buckets>
+            queue_latency_{};
+        std::array<std::atomic<std::uint64_t>, DurationHistogram::num_buckets>
+            execution_time_{};
+        std::atomic<std::uint64_t> num_executed_{ 0 };
+        std::atomic<std::uint64_t> num_failed_{ 0 };
+        std::atomic<std::int64_t> busy_ns_{ 0 };
+    };
 
-    /// Return a vector with the names of the tasks that are waiting to be executed.
-    GUL_EXPORT
-    std::vector<std::string> get_pending_task_names() const;
+    std::size_t capacity_{ 0 };
 
-    /// Return a vector with the names of the tasks that are currently running.
+    /// Determines whether the pool uses per-thread queues with work stealing.
+    bool work_stealing_{ false };
+
+    /// Waiting time after which a ready task is promoted by one priority level (or zero).
+    std::chrono::steady_clock::duration priority_aging_{ 0 };
+
+    /// Minimum and maximum number of worker threads (equal for a fixed-size pool).
+    std::size_t min_num_threads_{ 0 };
+    std::size_t max_num_threads_{ 0 };
+
+    /// Queue latency above which an additional thread is launched (when scaling).
+    std::chrono::steady_clock::duration spawn_latency_{ 0 };
+
+    /// Idle time after which a thread in excess of the minimum terminates.
+    std::chrono::steady_clock::duration keep_alive_{ 0 };
+
+    /// Current number of worker threads.
+    std::atomic<std::size_t> num_threads_{ 0 };
+
+    /// Flag set under mutex_ if an additional thread should be launched.
+    std::atomic<bool> spawn_requested_{ false };
+
+    std::mutex threads_mutex_; // Protects the following variables
+
+    /**
+     * Slots for the max_num_threads_ threads of the pool. Slots of terminated threads are
+     * reused, joining the old thread first.
+     */
+    std::vector<std::thread> threads_;
+
+    /// Flags for the slots in threads_ that are occupied by a running worker thread.
+    std::vector<bool> is_thread_active_;
+
+    /// CPUs to pin the worker threads to (round-robin), or empty for no pinning.
+    std::vector<int> cpus_;
+
+    /// CPU that each thread slot is pinned to, or -1.
+    std::vector<std::atomic<int>> thread_cpus_;
+
+    /// Prefix for the names of the worker threads (empty for unnamed threads).
+    std::string thread_name_;
+
+    /// Scheduling policy and priority for the worker threads.
+    ThreadSchedulingPolicy scheduling_policy_{ ThreadSchedulingPolicy::inherit };
+    int scheduling_priority_{ 0 };
+
+    /// Time for which idle threads poll for new tasks before going to sleep.
+    std::chrono::steady_clock::duration spin_time_{ 0 };
+
+    /**
+     * Per-thread data, indexed like threads_. This vector is only modified in the
+     * constructor.
+     */
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    /**
+     * Per-thread metrics, indexed like threads_. This vector is only filled if metrics
+     * are enabled and only modified in the constructor.
+     */
+    std::vector<std::unique_ptr<ThreadMetrics>> thread_metrics_;
+
+    /**
+     * Trace events recorded by a single worker thread in a ring buffer. The mutex is only
+     * contended while the trace is being read.
+     */
+    struct TraceBuffer
+    {
+        std::mutex mutex_; // Protects the following variables
+        std::vector<TraceEvent> events_;
+        std::size_t next_{ 0 }; // Index of the next event to be overwritten
+        bool is_full_{ false }; // Whether the buffer has wrapped around
+    };
+
+    /**
+     * Per-thread trace buffers, indexed like threads_. This vector is only filled if
+     * tracing is enabled and only modified in the constructor.
+     */
+    std::vector<std::unique_ptr<TraceBuffer>> traces_;
+
+    /// Time of construction (reference for the busy ratios of the metrics).
+    SteadyTimePoint creation_time_{ std::chrono::steady_clock::now() };
+
+    /// Number of canceled tasks (only counted if metrics are enabled).
+    std::atomic<std::uint64_t> num_canceled_{ 0 };
+
+    /// Highest number of pending tasks (only tracked if metrics are enabled).
+    std::atomic<std::size_t> max_pending_{ 0 };
+
+    /// Counters for the wake-up strategy (only tracked if metrics are enabled).
+    std::atomic<std::uint64_t> num_wakeups_{ 0 };
+    std::atomic<std::uint64_t> num_wakeups_avoided_{ 0 };
+    std::atomic<std::uint64_t> num_spin_hits_{ 0 };
+
+    /**
+     * For worker threads, this is the index of the thread in the threads_ vector.
+     * For other threads, the value is meaningless and the variable is initialized to
+     * numeric_limits<ThreadId>::max().
+     */
+    thread_local static ThreadId thread_id_;
+
+    /**
+     * For worker threads, this is a pointer to the pool that the thread belongs to.
+     * For other threads, it is null.
+     */
+    thread_local static const ThreadPool* current_pool_;
+
+    /// Number of pending tasks in all queues (shared and local).
+    std::atomic<std::size_t> num_pending_{ 0 };
+
+    /// Number of pending tasks in the local queues of the work-stealing mode.
+    std::atomic<std::size_t> num_local_tasks_{ 0 };
+
+    /// Number of ready tasks with high priority in the shared queue.
+    std::atomic<std::size_t> num_ready_high_priority_tasks_{ 0 };
+
+    /// Number of worker threads waiting on the condition variable.
+    std::atomic<std::size_t> num_sleeping_{ 0 };
+
+    /// Number of threads in wait_for_space().
+    std::atomic<std::size_t> num_waiting_producers_{ 0 };
+
+    /// Number of threads in wait_idle().
+    mutable std::atomic<std::size_t> num_idle_waiters_{ 0 };
+
+    /**
+     * A condition variable used together with mutex_ to wake up threads in wait_idle()
+     * when the pool might have become idle.
+     */
+    mutable std::condition_variable idle_cv_;
+
+    /**
+     * A mutex and condition variable used to wake up threads in wait_for_space() when
+     * the number of pending tasks drops.
+     */
+    std::mutex space_mutex_;
+    std::condition_variable space_cv_;
+
+    /// ID for the next task to be added.
+    std::atomic<TaskId> next_task_id_{ 0 };
+
+    /// Flag for requesting all worker threads to shut down.
+    std::atomic<bool> shutdown_requested_{ false };
+
+    /**
+     * A condition variable used together with mutex_ to wake up a worker thread when a
+     * new task is added (or when shutdown is requested).
+     */
+    std::condition_variable cv_;
+
+    mutable std::mutex mutex_; // Protects the following variables
+
+    /**
+     * Number of sleeping worker threads that have been notified but have not woken up
+     * yet. New tasks only cause a notification if there are more sleeping threads.
+     */
+    std::size_t num_signaled_{ 0 };
+
+    /// Storage for all tasks in the shared queue, reused via free_slots_.
+    std::vector<TaskSlot> task_slots_;
+    std::vector<SlotIndex> free_slots_;
+
+    /// Slot index for each task ID in the shared queue (except for detached tasks).
+    std::unordered_map<TaskId, SlotIndex> slot_index_;
+
+    /// FIFO lists of tasks that are ready to be started, indexed by priority.
+    std::array<ReadyList, num_priorities> ready_lists_;
+
+    /// Min-heap of slots with tasks waiting for their start time.
+    std::vector<SlotIndex> scheduled_tasks_;
+
+    /**
+     * A task that waits for other tasks to finish (a continuation or a node of a
+     * TaskGraph). It is moved to the shared queue once num_predecessors_ reaches zero.
+     */
+    struct BlockedTask
+    {
+        Task task_;
+        std::size_t num_predecessors_{ 0 };
+    };
+
+    /// Pending tasks that wait for other tasks to finish.
+    std::unordered_map<TaskId, BlockedTask> blocked_tasks_;
+
+    /// For each task that other tasks wait for, the IDs of the waiting tasks.
+    std::unordered_map<TaskId, std::vector<TaskId>> dependents_;
+
+    /**
+     * Number of entries in dependents_. This allows the workers of the work-stealing mode
+     * to skip locking mutex_ after a task has finished if no task waits for anything.
+     */
+    std::atomic<std::size_t> num_awaited_tasks_{ 0 };
+
+
+    /**
+     * Create a thread pool with the desired number of threads and the specified capacity
+     * for queuing tasks.
+     *
+     * This constructor may not be used directly. Use make_thread_pool() to allocate a
+     * ThreadPool object in a shared pointer.
+     *
+     * Upon construction, the desired number of threads is launched. The threads are
+     * joined when the ThreadPool object gets destroyed.
+     *
+     * \param options  Options for the pool (number of threads, capacity, ...)
+     *
+     * \exception std::invalid_argument is thrown if the desired number of threads is
+     *            zero or greater than max_threads, if the maximum number of threads is
+     *            nonzero and less than the number of threads or greater than
+     *            max_threads, if the requested capacity is zero or exceeds
+     *            max_capacity, if a duration option is out of range, if one of the
+     *            given CPU numbers is invalid, or if the scheduling priority is out of
+     *            range for the scheduling policy.
+     */
+    ThreadPool(const Options& options);
+
+    /**
+     * Remove the pending task associated with the specified ID.
+     *
+     * This call looks for a pending task with the given ID. If one is found, it is
+     * immediately removed and true is returned. If none is found, false is returned.
+     * This function has no impact on tasks that are currently being executed.
+     *
+     * \param task_id  Unique ID for the task to be removed
+     *
+     * \returns true if a task was removed, false if no pending task with the given ID was
+     *          found.
+     */
     GUL_EXPORT
-    std::vector<std::string> get_running_task_names() const;
+    bool cancel_pending_task(TaskId task_id);
 
     /**
-     * Return the thread pool ID of the current thread.
+     * Assign an ID to a task, put it into the appropriate queue, and wake up a worker
+     * thread.
      *
-     * \returns a thread ID in the range [0, count_threads()).
+     * Tasks without a start time that are added from a worker thread of a work-stealing
+     * pool go to the local queue of that thread, all others to the shared queue.
      *
-     * \exception std::runtime_error is thrown if this function is called from a thread
-     *            that is not part of the pool.
+     * \returns the unique ID assigned to the task.
+     * \exception std::runtime_error is thrown if the queue is full.
+     */
+    GUL_EXPORT
+    TaskId enqueue_task(Task task);
+
+    /**
+     * Try to enqueue a task like enqueue_task(), but do not throw if the queue is full.
+     * The task is only moved from if it was enqueued.
+     *
+     * \param task  The task to be enqueued
+     * \param id    Receives the unique ID assigned to the task
      *
-     * \since GUL version 2.13
+     * \returns true if the task was enqueued, false if the queue is full.
      */
     GUL_EXPORT
-    ThreadId get_thread_id() const;
-
-    /// Determine whether the queue for pending tasks is full (at capacity).
-    GUL_EXPORT
-    bool is_full() const noexcept;
+    bool try_enqueue_task(Task& task, TaskId& id);
 
     /**
-     * Return true if the pool has neither pending tasks nor tasks that are currently
-     * being executed.
+     * Enqueue a task like enqueue_task(), waiting until the given deadline for space in
+     * the queue if it is full. SteadyTimePoint::max() means to wait indefinitely.
+     *
+     * \returns true if the task was enqueued, false if the deadline has passed.
      */
     GUL_EXPORT
-    bool is_idle() const;
+    bool enqueue_task_wait(Task& task, TaskId& id, SteadyTimePoint deadline);
 
-    /// Determine whether the thread pool has been requested to shut down.
-    GUL_EXPORT
-    bool is_shutdown_requested() const;
+    /**
+     * Wait until the queue has room for at least one more task or the given deadline
+     * has passed. SteadyTimePoint::max() means to wait indefinitely.
+     *
+     * \returns true if there is space in the queue, false if the deadline has passed.
+     */
+    bool wait_for_space(SteadyTimePoint deadline);
 
     /**
-     * Create a thread pool with the desired number of threads and the specified capacity
-     * for enqueuing tasks.
+     * Assign consecutive IDs to a batch of tasks, put them into the appropriate queue,
+     * and wake up as many worker threads as needed.
      *
-     * The thread pool is allocated in a shared pointer, which is necessary so that task
-     * handles can access the pool safely. A ThreadPool cannot be constructed directly.
+     * The capacity is checked once for the whole batch: Either all tasks are enqueued or
+     * none. The tasks are moved out of the given vector.
      *
-     * \returns a shared pointer to the created ThreadPool object.
+     * \returns the ID assigned to the first task.
+     * \exception std::runtime_error is thrown if the queue cannot hold all tasks.
      */
     GUL_EXPORT
-    static std::shared_ptr<ThreadPool> make_shared(
-        std::size_t num_threads, std::size_t capacity = default_capacity);
+    TaskId enqueue_tasks(std::vector<Task>& tasks);
 
-private:
     /**
-     * An enum describing the internal state of a task on the ThreadPool.
+     * Assign an ID to a task and enqueue it so that it is started only after all of the
+     * given predecessors have finished. Predecessors that are neither pending nor running
+     * are considered finished.
      *
-     * This enum just describes if the task is pending, running, or neither. The pool has
-     * no further knowledge about the task, but a TaskHandle can additionally determine if
-     * a task has completed or been canceled.
+     * \returns the unique ID assigned to the task.
+     * \exception std::runtime_error is thrown if the queue is full.
      */
-    enum class InternalTaskState
-    {
-        /// The task is waiting to be started
-        pending = static_cast<int>(TaskState::pending),
-        /// The task is currently being executed
-        running = static_cast<int>(TaskState::running),
-        /// The thread pool has no knowledge about this task
-        unknown
-    };
+    GUL_EXPORT
+    TaskId enqueue_task_after(Task task, const std::vector<TaskId>& predecessors);
 
-    struct NamedTask
+    /**
+     * Enqueue a task that is started only after the given predecessors have finished.
+     * This is the common implementation of the continuations added with
+     * TaskHandle::then().
+     */
+    template <typename Function>
+    TaskHandle<std::invoke_result_t<Function, ThreadPool&>>
+    add_task_after(Function fct, const std::vector<TaskId>& predecessors,
+        std::string name)
     {
-        NamedTask(std::string name)
-        : name_{ std::move(name) }
-        {}
+        using Result = std::invoke_result_t<Function, ThreadPool&>;
+        using PackagedTask = std::packaged_task<Result(ThreadPool&)>;
 
-        virtual ~NamedTask() = default;
-        virtual void operator()(ThreadPool& pool) = 0;
+        auto named_task_ptr = std::make_unique<NamedTaskImpl<PackagedTask>>(
+            PackagedTask{ track_exceptions(std::move(fct)) }, std::move(name));
 
-        std::string name_;
-    };
+        auto future = named_task_ptr->fct_.get_future();
 
-    template <typename FunctionType>
-    struct NamedTaskImpl : public NamedTask
-    {
-    public:
-        NamedTaskImpl(FunctionType fct, std::string name)
-        : NamedTask{ std::move(name) }
-        , fct_{ std::move(fct) }
-        {}
+        const TaskId id = enqueue_task_after(
+            Task{ 0, std::move(named_task_ptr), SteadyTimePoint{} }, predecessors);
 
-        void operator()(ThreadPool& pool) override { fct_(pool); }
+        return TaskHandle<Result>{ id, std::move(future), shared_from_this() };
+    }
 
-        FunctionType fct_;
-    };
+    /**
+     * Notify the tasks waiting for the given task that it has finished (or has been
+     * canceled). Tasks without further unfinished predecessors are moved to the shared
+     * queue. This function must be called with mutex_ locked.
+     *
+     * \returns the number of tasks that have become ready.
+     */
+    std::size_t release_dependents_i(TaskId task_id);
 
-    struct Task
-    {
-        TaskId id_{};
-        std::unique_ptr<NamedTask> named_task_;
-        TimePoint start_time_{}; // When the task is to be started (at least no earlier)
+    /**
+     * Return a lock on the mutex of each worker thread, acquired in the order of the
+     * thread IDs. Together with mutex_, this freezes the state of all queues.
+     */
+    std::vector<std::unique_lock<std::mutex>> lock_workers() const;
 
-        Task() = default;
+    /**
+     * Pop the newest task from the local queue of the given thread and mark it as
+     * running.
+     *
+     * \returns true if a task was found, false if the local queue is empty.
+     */
+    bool pop_local_task(ThreadId thread_id, Task& task);
 
-        Task(TaskId task_id, std::unique_ptr<NamedTask> named_task, TimePoint start_time)
-        : id_{ task_id }
-        , named_task_{ std::move(named_task) }
-        , start_time_{ start_time }
-        {}
-    };
+    /**
+     * Pop the next ready task from the shared queue without waiting and mark it as
+     * running on the given worker thread (work-stealing mode only).
+     *
+     * \returns true if a task was found, false if no task is ready.
+     */
+    bool pop_shared_task(ThreadId thread_id, Task& task);
 
-    std::size_t capacity_{ 0 };
+    /**
+     * Remove the next ready task from the shared queue (internal non-locking version).
+     *
+     * If no task is ready to be started, this function waits on the condition variable
+     * until new work might be available and returns false.
+     *
+     * \param lock  A lock on mutex_
+     * \param task  Output parameter for the removed task
+     *
+     * \returns true if a task was removed from the queue, false otherwise.
+     */
+    bool pop_ready_task_i(std::unique_lock<std::mutex>& lock, Task& task);
 
     /**
-     * The threads in the pool. This variable is only modified in the constructor and not
-     * protected by the mutex.
+     * Remove the next ready task from the shared queue without waiting (internal
+     * non-locking version).
+     *
+     * \returns true if a task was removed from the queue, false if no task is ready.
      */
-    std::vector<std::thread> threads_;
+    bool try_pop_ready_task_i(Task& task);
 
     /**
-     * For worker threads, this is the index of the thread in the threads_ vector.
-     * For other threads, the value is meaningless and the variable is initialized to
-     * numeric_limits<ThreadId>::max().
+     * Determine the slot of the ready task that is to be started next (internal
+     * non-locking version).
+     *
+     * This is the oldest ready task of the highest priority. If priority aging is
+     * enabled, the priority of each task is raised by the number of aging intervals it
+     * has been waiting.
+     *
+     * \returns the slot index or no_slot if no task is ready.
      */
-    thread_local static ThreadId thread_id_;
+    SlotIndex select_ready_slot_i() const;
 
     /**
-     * A condition variable used together with mutex_ to wake up a worker thread when a
-     * new task is added (or when shutdown is requested).
+     * Move all tasks whose start time has come from the heap of scheduled tasks to the
+     * end of the FIFO lists of ready tasks (internal non-locking version).
      */
-    std::condition_variable cv_;
+    void promote_due_tasks_i(SteadyTimePoint now);
 
-    mutable std::mutex mutex_; // Protects the following variables
-    std::vector<Task> pending_tasks_;
-    std::vector<TaskId> running_task_ids_;
-    std::vector<std::string> running_task_names_;
-    TaskId next_task_id_ = 0;
-    bool shutdown_requested_{ false };
+    /**
+     * Put a task into a free slot of the shared queue (internal non-locking version).
+     *
+     * Tasks without a start time or with a start time in the past are appended to the
+     * FIFO list of ready tasks for their priority, all others are pushed onto the heap of
+     * scheduled tasks.
+     */
+    void push_task_i(Task task);
 
+    /**
+     * Append a slot to the FIFO list of ready tasks for the priority of its task
+     * (internal non-locking version).
+     */
+    void push_ready_slot_i(SlotIndex slot);
 
     /**
-     * Create a thread pool with the desired number of threads and the specified capacity
-     * for queuing tasks.
-     *
-     * This constructor may not be used directly. Use make_thread_pool() to allocate a
-     * ThreadPool object in a shared pointer.
+     * Remove the task in the given slot from the shared queue and release the slot
+     * (internal non-locking version).
      *
-     * Upon construction, the desired number of threads is launched. The threads are
-     * joined when the ThreadPool object gets destroyed.
-     *
-     * \param num_threads  Desired number of threads
-     * \param capacity     Maximum number of pending tasks that can be queued
+     * \returns the removed task.
+     */
+    Task take_task_i(SlotIndex slot);
+
+    /// Restore the heap property for an element that may be too small for its position.
+    void scheduled_sift_up_i(std::size_t pos);
+
+    /// Restore the heap property for an element that may be too large for its position.
+    void scheduled_sift_down_i(std::size_t pos);
+
+    /**
+     * Convert a time point of the system clock into a time point of the steady clock.
      *
-     * \exception std::invalid_argument is thrown if the desired number of threads is
-     *            zero or greater than max_threads, or if the requested capacity is zero
-     *            or exceeds max_capacity.
+     * The default-constructed TimePoint{} is mapped to SteadyTimePoint{}, i.e. "as soon
+     * as possible". Time points that are too far in the future for the steady clock are
+     * mapped to SteadyTimePoint::max().
      */
-    ThreadPool(std::size_t num_threads, std::size_t capacity);
+    static SteadyTimePoint to_steady_time_point(TimePoint time_point)
+    {
+        if (time_point == TimePoint{})
+            return SteadyTimePoint{};
+
+        const auto steady_now = std::chrono::steady_clock::now();
+        const auto delay = time_point - std::chrono::system_clock::now();
+
+        if (delay <= Duration::zero())
+            return steady_now;
+
+        if (delay >= SteadyTimePoint::max() - steady_now)
+            return SteadyTimePoint::max();
+
+        return steady_now
+            + std::chrono::duration_cast<SteadyTimePoint::duration>(delay);
+    }
+
+    /// Determine whether the task in slot a is to be started before the one in slot b.
+    bool starts_before_i(SlotIndex a, SlotIndex b) const noexcept;
 
     /**
-     * Remove the pending task associated with the specified ID.
+     * Put a periodic task back into the shared queue after an execution (internal
+     * non-locking version).
      *
-     * This call looks for a pending task with the given ID. If one is found, it is
-     * immediately removed and true is returned. If none is found, false is returned.
-     * This function has no impact on tasks that are currently being executed.
+     * \returns true if the task was requeued, false if it is not periodic or has been
+     *          canceled (in which case the task object is left untouched).
+     */
+    bool requeue_periodic_task_i(Task& task);
+
+    /**
+     * Reserve space for additional pending tasks. Either all requested slots are
+     * reserved or none.
      *
-     * \param task_id  Unique ID for the task to be removed
+     * \exception std::runtime_error is thrown if the queue does not have enough space.
+     */
+    void reserve_pending_slots(std::size_t num_slots = 1);
+
+    /**
+     * Reserve space for additional pending tasks like reserve_pending_slots(), but
+     * return false instead of throwing if the queue does not have enough space.
+     */
+    bool try_reserve_pending_slots(std::size_t num_slots = 1) noexcept;
+
+    /**
+     * Release the space of pending tasks that have been started or removed from the
+     * queue and wake up producers waiting for space.
+     */
+    void release_pending_slots(std::size_t num_slots = 1);
+
+    /**
+     * Steal the oldest task from the local queue of another thread and mark it as
+     * running on the given thread.
      *
-     * \returns true if a task was removed, false if no pending task with the given ID was
-     *          found.
+     * \returns true if a task was found, false if all other queues are empty.
      */
-    GUL_EXPORT
-    bool cancel_pending_task(TaskId task_id);
+    bool steal_task(ThreadId thread_id, Task& task);
 
     /**
      * Determine the state of the task with the specified ID.
@@ -598,6 +2721,142 @@ private:
     GUL_EXPORT
     InternalTaskState get_task_state(TaskId task_id) const;
 
+    /**
+     * Determine the state of the task with the given ID (internal non-locking version).
+     * This function must be called with mutex_ and all worker mutexes locked.
+     */
+    InternalTaskState get_task_state_i(TaskId task_id) const;
+
+    /**
+     * Turn a function object with signature `T fct()` into one with signature
+     * `T fct(ThreadPool&)`. Function objects that already accept a ThreadPool reference
+     * are returned unchanged.
+     */
+    template <typename Function>
+    static auto with_pool_argument(Function fct)
+    {
+        if constexpr (std::is_invocable<Function, ThreadPool&>::value)
+            return fct;
+        else
+            return [f = std::move(fct)](ThreadPool&) mutable { return f(); };
+    }
+
+    /**
+     * Turn a function object that takes a StopToken as its last argument into one with
+     * signature `T fct(ThreadPool&)` or `T fct()` and create the flag behind the token in
+     * stop_state. Other function objects are returned unchanged.
+     */
+    template <typename Function>
+    static auto with_stop_token(Function fct,
+        std::shared_ptr<std::atomic<bool>>& stop_state)
+    {
+        if constexpr (not detail::takes_stop_token_v<Function>)
+        {
+            return fct;
+        }
+        else
+        {
+            stop_state = std::make_shared<std::atomic<bool>>(false);
+            StopToken token{ stop_state };
+
+            if constexpr (std::is_invocable<Function, ThreadPool&, StopToken>::value)
+            {
+                return [f = std::move(fct), token = std::move(token)](ThreadPool& pool)
+                    mutable { return f(pool, token); };
+            }
+            else
+            {
+                return [f = std::move(fct), token = std::move(token)]() mutable
+                    { return f(token); };
+            }
+        }
+    }
+
+    /**
+     * Wrap a function object in a packaged task and create a Task for it that can be
+     * passed to one of the enqueue functions.
+     */
+    template <typename Function>
+    static auto prepare_task(Function fct, SteadyTimePoint start_time,
+        TaskPriority priority, std::string name)
+    {
+        static_assert(
+            std::is_invocable<Function, ThreadPool&>::value
+            || std::is_invocable<Function>::value
+            || detail::takes_stop_token_v<Function>,
+            "Invalid function signature: Must be T fct() or T fct(ThreadPool&), "
+            "optionally with an additional StopToken argument");
+
+        std::shared_ptr<std::atomic<bool>> stop_state;
+        auto pool_fct = with_pool_argument(with_stop_token(std::move(fct), stop_state));
+
+        using Result = std::invoke_result_t<decltype(pool_fct)&, ThreadPool&>;
+        using PackagedTask = std::packaged_task<Result(ThreadPool&)>;
+
+        auto named_task_ptr = std::make_unique<NamedTaskImpl<PackagedTask>>(
+            PackagedTask{ track_exceptions(std::move(pool_fct)) }, std::move(name));
+
+        auto future = named_task_ptr->fct_.get_future();
+
+        return PreparedTask<Result>{
+            Task{ 0, std::move(named_task_ptr), start_time, priority },
+            std::move(future), std::move(stop_state) };
+    }
+
+    /// Create the handle for an enqueued task from its ID and prepared future.
+    template <typename Result>
+    TaskHandle<Result> make_handle(TaskId id, PreparedTask<Result>& prepared)
+    {
+        return TaskHandle<Result>{ id, std::move(prepared.future_), shared_from_this(),
+            std::move(prepared.stop_state_) };
+    }
+
+    /**
+     * Wrap a function object with signature `T fct(ThreadPool&)` so that exceptions
+     * thrown by it are counted in the metrics of the pool before they are passed on.
+     */
+    template <typename Function>
+    static auto track_exceptions(Function fct)
+    {
+        using Result = std::invoke_result_t<Function&, ThreadPool&>;
+
+        return [f = std::move(fct)](ThreadPool& pool) mutable -> Result
+            {
+                try
+                {
+                    return f(pool);
+                }
+                catch (...)
+                {
+                    pool.count_task_exception();
+                    throw;
+                }
+            };
+    }
+
+    /**
+     * Record that a task running on the current worker thread has thrown an exception
+     * (for the metrics).
+     */
+    GUL_EXPORT
+    void count_task_exception() noexcept;
+
+    /**
+     * Execute a task on the current worker thread, catching all exceptions and updating
+     * the metrics and the trace if enabled.
+     */
+    void execute_task(Task& task);
+
+    /// Determine whether tasks need to be stamped with their enqueue time.
+    bool needs_enqueue_time() const noexcept
+    {
+        return not thread_metrics_.empty() || not traces_.empty();
+    }
+
+    /// Record a trace event for a task executed by the current worker thread.
+    void record_trace_event(const Task& task, SteadyTimePoint start_time,
+        SteadyTimePoint end_time);
+
     /**
      * Determine whether the queue for pending tasks is full (internal non-locking
      * version).
@@ -605,6 +2864,24 @@ private:
     GUL_EXPORT
     bool is_full_i() const noexcept;
 
+    /**
+     * Determine whether the pool has neither pending nor running tasks. This function
+     * must be called with mutex_ and the mutexes of all workers locked.
+     */
+    bool is_idle_i() const;
+
+    /**
+     * Wake up the threads in wait_idle() if the pool might have become idle. This
+     * function must be called with mutex_ locked.
+     */
+    void notify_idle_waiters_i();
+
+    /// Wait until the pool is idle or the deadline has passed (see wait_idle()).
+    bool wait_idle_until(SteadyTimePoint deadline) const;
+
+    /// Join all worker threads (after shutdown has been requested).
+    void join_threads();
+
     /**
      * The main loop run in the thread; picks one task off the queue and executes it, then
      * repeats until asked to quit.
@@ -612,6 +2889,67 @@ private:
      * \param thread_index  Index of the thread in the threads_ vector
      */
     void perform_work(std::size_t thread_index);
+
+    /**
+     * Apply the CPU affinity, name, and scheduling policy from the options to the
+     * calling worker thread. Failures are ignored.
+     */
+    void configure_worker_thread(ThreadId thread_id);
+
+    /// The work loop for pools with a single shared queue.
+    void perform_work_shared_queue(ThreadId thread_id);
+
+    /// The work loop for pools with per-thread queues and work stealing.
+    void perform_work_stealing(ThreadId thread_id);
+
+    /// Wake up sleeping worker threads for the given number of new local tasks.
+    void wake_sleeping_workers(std::size_t num_tasks = 1);
+
+    /**
+     * Determine how many sleeping worker threads need to be woken up for the given
+     * number of new tasks and mark them as notified. Threads that have already been
+     * notified are not counted. This function must be called with mutex_ locked.
+     *
+     * \returns the number of threads to be woken up with notify_workers().
+     */
+    std::size_t claim_wakeups_i(std::size_t num_tasks);
+
+    /// Wake up the given number of sleeping worker threads (see claim_wakeups_i()).
+    void notify_workers(std::size_t num_wakeups);
+
+    /**
+     * Poll for new tasks for up to spin_time_ (mutex_ must not be locked).
+     *
+     * \returns true if new work may have arrived.
+     */
+    bool spin_for_work(std::size_t num_pending) const;
+
+    /// Determine whether the number of threads can change at runtime.
+    bool is_scaling() const noexcept { return max_num_threads_ > min_num_threads_; }
+
+    /**
+     * Request an additional worker thread if no thread is idle and the ready task that
+     * became ready at the given time has been waiting longer than the spawn latency.
+     * This function must be called with mutex_ locked.
+     */
+    void check_queue_latency_i(SteadyTimePoint ready_since);
+
+    /**
+     * Return the time at which the oldest ready task in the shared queue became ready,
+     * or SteadyTimePoint::max() if there is none. This function must be called with
+     * mutex_ locked.
+     */
+    SteadyTimePoint get_oldest_ready_time_i() const;
+
+    /// Launch an additional worker thread if one has been requested and there is room.
+    void spawn_worker();
+
+    /**
+     * Decide whether the calling worker thread, which has been idle since the given time,
+     * should terminate because it exceeded the keep-alive time. If so, the thread is
+     * no longer counted. This function must be called with mutex_ locked.
+     */
+    bool retire_worker_i(SteadyTimePoint idle_since);
 };
 
 /**
@@ -629,6 +2967,23 @@ inline std::shared_ptr<ThreadPool> make_thread_pool(
     return ThreadPool::make_shared(num_threads, capacity);
 }
 
+/**
+ * Create a thread pool with the given options.
+ *
+ * \code{.cpp}
+ * ThreadPool::Options options;
+ * options.num_threads = 8;
+ * options.work_stealing = true;
+ * auto pool = make_thread_pool(options);
+ * \endcode
+ *
+ * \returns a shared pointer to the created ThreadPool object.
+ */
+inline std::shared_ptr<ThreadPool> make_thread_pool(const ThreadPool::Options& options)
+{
+    return ThreadPool::make_shared(options);
+}
+
 /// @}
 
 } // namespace gul17
@@ -0,0 +1,217 @@
+/**
+ * \file  coroutine.h
+ * \date  Created on October 17, 2026
+ * \brief Declaration of awaitables for using ThreadPool from C++20 coroutines.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_COROUTINE_H_
+#define GUL17_COROUTINE_H_
+
+#include <future>
+#include <utility>
+
+#include "gul17/ThreadPool.h"
+
+// The awaitables are only available if the compiler and the standard library support
+// coroutines (C++20). Otherwise, this header is empty.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#   include <coroutine>
+#endif
+
+#if defined(__cpp_lib_coroutine)
+
+namespace gul17 {
+
+namespace detail {
+
+/// An awaitable that resumes the awaiting coroutine in a task on a ThreadPool.
+class ScheduleAwaiter
+{
+public:
+    ScheduleAwaiter(ThreadPool& pool, ThreadPool::SteadyTimePoint start_time) noexcept
+        : pool_{ pool }
+        , start_time_{ start_time }
+    {}
+
+    bool await_ready() const noexcept { return false; }
+
+    void await_suspend(std::coroutine_handle<> coroutine)
+    {
+        pool_.add_detached_task([coroutine]() { coroutine.resume(); }, start_time_);
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    ThreadPool& pool_;
+    ThreadPool::SteadyTimePoint start_time_;
+};
+
+/**
+ * An awaitable that resumes the awaiting coroutine once a ThreadPool task has finished
+ * and returns the result of the task.
+ */
+template <typename T>
+class TaskHandleAwaiter
+{
+public:
+    explicit TaskHandleAwaiter(ThreadPool::TaskHandle<T>&& handle)
+        : handle_{ std::move(handle) }
+    {}
+
+    bool await_ready() const { return handle_.is_complete(); }
+
+    void await_suspend(std::coroutine_handle<> coroutine)
+    {
+        // The coroutine may be resumed (and this object destroyed) on a worker thread
+        // before when_finished() returns, so nothing must be accessed afterwards.
+        handle_.when_finished(
+            [this, coroutine](std::future<T> future)
+            {
+                future_ = std::move(future);
+                coroutine.resume();
+            });
+    }
+
+    T await_resume()
+    {
+        if (future_.valid())
+            return future_.get();
+
+        return handle_.get_result(); // Task was complete before suspending
+    }
+
+private:
+    ThreadPool::TaskHandle<T> handle_;
+    std::future<T> future_;
+};
+
+} // namespace detail
+
+/**
+ * \addtogroup coroutine_h gul17/coroutine.h
+ * \brief Awaitables for using a ThreadPool from C++20 coroutines.
+ * @{
+ */
+
+/**
+ * Return an awaitable that continues the awaiting coroutine on a worker thread of the
+ * given pool.
+ *
+ * The coroutine is resumed from a detached task (see ThreadPool::add_detached_task()).
+ * No thread is blocked in the meantime.
+ *
+ * \exception std::runtime_error is thrown from the `co_await` expression if the queue of
+ *            the pool is full.
+ *
+ * \note
+ * If the pool is destroyed before the task has been started, the coroutine is never
+ * resumed.
+ *
+ * \code{.cpp}
+ * Task<void> process(ThreadPool& pool) // Task<> is a coroutine type of your choice
+ * {
+ *     co_await schedule(pool);
+ *     // From here on, the coroutine runs on a worker thread of the pool
+ *     heavy_computation();
+ * }
+ * \endcode
+ */
+inline detail::ScheduleAwaiter schedule(ThreadPool& pool) noexcept
+{
+    return detail::ScheduleAwaiter{ pool, ThreadPool::SteadyTimePoint{} };
+}
+
+/**
+ * Return an awaitable that suspends the awaiting coroutine for the given time and
+ * continues it on a worker thread of the given pool afterwards.
+ *
+ * The coroutine is resumed from a delayed detached task, so no thread is blocked while
+ * waiting. The same restrictions as for schedule() apply. Any std::chrono::duration can
+ * be passed; durations that reach beyond the range of the steady clock (such as
+ * duration::max()) make the coroutine wait forever.
+ *
+ * \code{.cpp}
+ * co_await sleep_for(pool, 100ms);
+ * \endcode
+ */
+template <typename Rep, typename Period>
+detail::ScheduleAwaiter
+sleep_for(ThreadPool& pool, std::chrono::duration<Rep, Period> duration)
+{
+    return detail::ScheduleAwaiter{ pool, detail::get_deadline(duration) };
+}
+
+/**
+ * Return an awaitable that suspends the awaiting coroutine until the given time point
+ * and continues it on a worker thread of the given pool afterwards.
+ *
+ * The coroutine is resumed from a delayed detached task, so no thread is blocked while
+ * waiting. The same restrictions as for schedule() apply.
+ */
+inline detail::ScheduleAwaiter
+sleep_until(ThreadPool& pool, ThreadPool::SteadyTimePoint time_point) noexcept
+{
+    return detail::ScheduleAwaiter{ pool, time_point };
+}
+
+/**
+ * Wait for a ThreadPool task to finish and return its result.
+ *
+ * If the task has already finished, the awaiting coroutine simply continues. Otherwise,
+ * it is suspended and resumed on a worker thread of the pool once the task has finished,
+ * without blocking any thread in the meantime. If the task threw an exception, the
+ * exception is rethrown from the `co_await` expression. A canceled task yields a
+ * std::future_error with the error code broken_promise.
+ *
+ * Like TaskHandle::then(), this consumes the result of the task, so it can only be
+ * applied to an rvalue.
+ *
+ * \exception std::logic_error is thrown if the task has no result (e.g. because it has
+ *            been canceled via the handle) or if the pool does not exist anymore.
+ *            std::runtime_error is thrown if the queue of the pool is full.
+ *
+ * \note
+ * If the pool is destroyed before the task has finished, the coroutine is never resumed.
+ *
+ * \code{.cpp}
+ * Task<int> sum_of_squares(ThreadPool& pool) // Task<> is a coroutine type of your choice
+ * {
+ *     auto a = pool.add_task([]() { return 3 * 3; });
+ *     auto b = pool.add_task([]() { return 4 * 4; });
+ *     co_return co_await std::move(a) + co_await std::move(b);
+ * }
+ * \endcode
+ */
+template <typename T>
+detail::TaskHandleAwaiter<T> operator co_await(ThreadPool::TaskHandle<T>&& handle)
+{
+    return detail::TaskHandleAwaiter<T>{ std::move(handle) };
+}
+
+/// @}
+
+} // namespace gul17
+
+#endif // defined(__cpp_lib_coroutine)
+
+#endif // GUL17_COROUTINE_H_
@@ -42,6 +42,7 @@
 #include "gul17/bit_manip.h"
 #include "gul17/case_ascii.h"
 #include "gul17/cat.h"
+#include "gul17/coroutine.h"
 // #include "gul17/date.h" not included by default to reduce compile times
 #include "gul17/escape.h"
 #include "gul17/expected.h"
@@ -49,12 +50,16 @@
 #include "gul17/gcd_lcm.h"
 #include "gul17/hexdump.h"
 #include "gul17/join_split.h"
+#include "gul17/MpmcQueue.h"
 #include "gul17/num_util.h"
 #include "gul17/OverloadSet.h"
+#include "gul17/parallel.h"
 #include "gul17/replace.h"
+#include "gul17/RollingStatistics.h"
 #include "gul17/SlidingBuffer.h"
 #include "gul17/SmallVector.h"
 #include "gul17/span.h"
+#include "gul17/SpscRingBuffer.h"
 #include "gul17/statistics.h"
 #include "gul17/string_util.h"
 #include "gul17/substring_checks.h"
@@ -0,0 +1,368 @@
+/**
+ * \file  parallel.h
+ * \date  Created on October 16, 2026
+ * \brief Declaration of parallel_for() and parallel_reduce().
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef GUL17_PARALLEL_H_
+#define GUL17_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gul17/ThreadPool.h"
+
+namespace gul17 {
+
+namespace detail {
+
+/**
+ * State shared between the caller of a parallel loop and the helper tasks that it adds
+ * to the pool.
+ *
+ * Chunks are handed out through an atomic counter. Whoever claims a chunk (the caller or
+ * a helper task) executes it. Helper tasks that start after all chunks have been claimed
+ * return immediately without touching the chunk function, so the state can safely
+ * outlive the call.
+ */
+template <typename ChunkFunction>
+class ParallelLoopState
+{
+public:
+    ParallelLoopState(std::size_t num_chunks, ChunkFunction fct)
+        : fct_{ std::move(fct) }
+        , num_chunks_{ num_chunks }
+    {}
+
+    /// Claim and execute chunks until there are none left.
+    void work()
+    {
+        std::size_t num_processed = 0;
+
+        for (;;)
+        {
+            const auto chunk = next_chunk_++;
+            if (chunk >= num_chunks_)
+                break;
+
+            // After a failure, the remaining chunks are only counted, not executed
+            if (not failed_)
+            {
+                try
+                {
+                    fct_(chunk);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (not exception_)
+                        exception_ = std::current_exception();
+                    failed_ = true;
+                }
+            }
+
+            ++num_processed;
+        }
+
+        if (num_processed == 0)
+            return;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        num_done_ += num_processed;
+        if (num_done_ == num_chunks_)
+            cv_.notify_all();
+    }
+
+    /**
+     * Wait until all chunks have been executed.
+     * \exception Rethrows the first exception thrown by the chunk function.
+     */
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this]() { return num_done_ == num_chunks_; });
+
+        if (exception_)
+            std::rethrow_exception(exception_);
+    }
+
+private:
+    ChunkFunction fct_;
+    const std::size_t num_chunks_;
+    std::atomic<std::size_t> next_chunk_{ 0 };
+    std::atomic<bool> failed_{ false };
+
+    std::mutex mutex_; // Protects the following members and is used with cv_
+    std::condition_variable cv_;
+    std::size_t num_done_{ 0 };
+    std::exception_ptr exception_;
+};
+
+/**
+ * Execute chunk_fct(0) ... chunk_fct(num_chunks - 1) on the calling thread and on up to
+ * ThreadPool::count_threads() workers of the pool.
+ *
+ * The calling thread always takes part in the work. Therefore, the function cannot
+ * deadlock even if it is called from a worker of the same pool while all other workers
+ * are busy, or if the queue of the pool is full.
+ */
+template <typename ChunkFunction>
+void run_parallel_chunks(ThreadPool& pool, std::size_t num_chunks,
+    ChunkFunction chunk_fct)
+{
+    if (num_chunks == 0)
+        return;
+
+    if (num_chunks == 1)
+    {
+        chunk_fct(std::size_t{ 0 });
+        return;
+    }
+
+    auto state = std::make_shared<ParallelLoopState<ChunkFunction>>(
+        num_chunks, std::move(chunk_fct));
+
+    const auto num_helpers = std::min(num_chunks - 1, pool.count_threads());
+
+    for (std::size_t i = 0; i != num_helpers; ++i)
+    {
+        try
+        {
+            pool.add_detached_task([state]() { state->work(); });
+        }
+        catch (const std::runtime_error&)
+        {
+            break; // Queue is full: The calling thread does the remaining work
+        }
+    }
+
+    state->work();
+    state->wait();
+}
+
+/**
+ * Return the number of indices in the range [begin, end) with end > begin.
+ *
+ * The difference is calculated in the unsigned counterpart of Index, so that it does not
+ * overflow even for ranges that are wider than the maximum value of Index. The outer
+ * cast undoes the integer promotion of types narrower than int.
+ */
+template <typename Index>
+std::size_t get_index_distance(Index begin, Index end) noexcept
+{
+    using UnsignedIndex = std::make_unsigned_t<Index>;
+    return static_cast<std::size_t>(static_cast<UnsignedIndex>(
+        static_cast<UnsignedIndex>(end) - static_cast<UnsignedIndex>(begin)));
+}
+
+/// Return the index that lies offset positions behind begin, without signed overflow.
+template <typename Index>
+Index get_nth_index(Index begin, std::size_t offset) noexcept
+{
+    using UnsignedIndex = std::make_unsigned_t<Index>;
+    return static_cast<Index>(
+        static_cast<UnsignedIndex>(begin) + static_cast<UnsignedIndex>(offset));
+}
+
+/**
+ * A partial result of parallel_reduce().
+ *
+ * Each chunk writes its own slot from a different thread. Wrapping the value prevents
+ * std::vector<bool> from packing several slots into one word, and aligning the slots to
+ * cache lines keeps the writing threads from disturbing each other's caches.
+ */
+template <typename T>
+struct alignas(64) alignas(T) PartialResult
+{
+    T value;
+};
+
+/**
+ * Determine the number and size of chunks for a loop over num_elements elements.
+ * A grain_size of zero selects a chunk size that gives a few chunks per thread.
+ */
+inline std::pair<std::size_t, std::size_t>
+get_parallel_chunking(const ThreadPool& pool, std::size_t num_elements,
+    std::size_t grain_size)
+{
+    if (grain_size == 0)
+    {
+        const auto target_num_chunks = 4 * (pool.count_threads() + 1);
+        grain_size = std::max<std::size_t>(
+            1, (num_elements + target_num_chunks - 1) / target_num_chunks);
+    }
+
+    const auto num_chunks = (num_elements + grain_size - 1) / grain_size;
+    return { num_chunks, grain_size };
+}
+
+} // namespace detail
+
+/**
+ * \addtogroup parallel_h gul17/parallel.h
+ * \brief Parallel loops on top of ThreadPool.
+ * @{
+ */
+
+/**
+ * Call a function for every index in the range [begin, end) in parallel.
+ *
+ * The index range is split into chunks that are executed by worker threads of the given
+ * pool and by the calling thread itself. The function returns when all indices have been
+ * processed.
+ *
+ * Because the calling thread participates in the work, parallel_for() can safely be
+ * called from within a task running on the same pool: If no worker is available, the
+ * calling thread simply processes all chunks on its own.
+ *
+ * \param pool  The ThreadPool whose worker threads help to process the chunks
+ * \param begin First index
+ * \param end   One past the last index
+ * \param fct   A function object with signature `void fct(Index i)` that is called for
+ *              each index. It is called concurrently from several threads.
+ * \param grain_size  Number of consecutive indices per chunk. The default of zero
+ *              selects a chunk size that gives a few chunks per thread.
+ *
+ * \exception If fct throws, no further chunks are started and the first exception is
+ *            rethrown once all chunks that are already running have finished.
+ *
+ * \code{.cpp}
+ * auto pool = make_thread_pool(4);
+ * std::vector<double> samples(1'000'000);
+ * parallel_for(*pool, std::size_t{ 0 }, samples.size(),
+ *     [&samples](std::size_t i) { samples[i] = std::sin(0.001 * i); });
+ * \endcode
+ */
+template <typename Index, typename Function>
+void parallel_for(ThreadPool& pool, Index begin, Index end, Function fct,
+    std::size_t grain_size = 0)
+{
+    static_assert(std::is_integral<Index>::value, "Index must be an integral type");
+
+    if (end <= begin)
+        return;
+
+    const auto num_elements = detail::get_index_distance(begin, end);
+    const auto [num_chunks, chunk_size] =
+        detail::get_parallel_chunking(pool, num_elements, grain_size);
+
+    detail::run_parallel_chunks(pool, num_chunks,
+        [begin, num_elements, chunk_size = chunk_size, &fct](std::size_t chunk)
+        {
+            const auto first = chunk * chunk_size;
+            const auto last = std::min(first + chunk_size, num_elements);
+
+            for (auto i = first; i != last; ++i)
+                fct(detail::get_nth_index(begin, i));
+        });
+}
+
+/**
+ * Map every index in the range [begin, end) to a value and combine all values in
+ * parallel.
+ *
+ * The index range is split into chunks that are processed by worker threads of the given
+ * pool and by the calling thread itself. Each chunk is reduced separately, starting from
+ * a copy of identity, and the partial results are finally combined on the calling
+ * thread in the order of the chunks. The reduction function therefore has to be
+ * associative, but it need not be commutative.
+ *
+ * As with parallel_for(), the calling thread participates in the work, so the function
+ * can safely be called from within a task running on the same pool.
+ *
+ * \param pool      The ThreadPool whose worker threads help to process the chunks
+ * \param begin     First index
+ * \param end       One past the last index
+ * \param identity  Identity element of the reduction (e.g. 0 for a sum)
+ * \param fct       A function object with signature `T fct(Index i)` that maps an index
+ *                  to a value. It is called concurrently from several threads.
+ * \param reduce    A function object with signature `T reduce(T a, T b)` that combines
+ *                  two values
+ * \param grain_size  Number of consecutive indices per chunk. The default of zero
+ *                  selects a chunk size that gives a few chunks per thread.
+ *
+ * \returns the combination of all mapped values, or identity if the range is empty.
+ *
+ * \exception If fct or reduce throw, no further chunks are started and the first
+ *            exception is rethrown once all chunks that are already running have
+ *            finished.
+ *
+ * \code{.cpp}
+ * auto pool = make_thread_pool(4);
+ * std::vector<double> samples = get_samples();
+ * double sum_of_squares = parallel_reduce(*pool, std::size_t{ 0 }, samples.size(), 0.0,
+ *     [&samples](std::size_t i) { return samples[i] * samples[i]; },
+ *     std::plus<>{});
+ * \endcode
+ */
+template <typename Index, typename T, typename Function, typename Reduction>
+T parallel_reduce(ThreadPool& pool, Index begin, Index end, T identity, Function fct,
+    Reduction reduce, std::size_t grain_size = 0)
+{
+    static_assert(std::is_integral<Index>::value, "Index must be an integral type");
+
+    if (end <= begin)
+        return identity;
+
+    const auto num_elements = detail::get_index_distance(begin, end);
+    const auto [num_chunks, chunk_size] =
+        detail::get_parallel_chunking(pool, num_elements, grain_size);
+
+    std::vector<detail::PartialResult<T>> partial_results(
+        num_chunks, detail::PartialResult<T>{ identity });
+
+    detail::run_parallel_chunks(pool, num_chunks,
+        [begin, num_elements, chunk_size = chunk_size, &fct, &reduce, &partial_results](
+            std::size_t chunk)
+        {
+            const auto first = chunk * chunk_size;
+            const auto last = std::min(first + chunk_size, num_elements);
+
+            T result = std::move(partial_results[chunk].value);
+            for (auto i = first; i != last; ++i)
+            {
+                result = reduce(std::move(result), fct(detail::get_nth_index(begin, i)));
+            }
+            partial_results[chunk].value = std::move(result);
+        });
+
+    T result = std::move(identity);
+    for (auto& partial_result : partial_results)
+        result = reduce(std::move(result), std::move(partial_result.value));
+
+    return result;
+}
+
+/// @}
+
+} // namespace gul17
+
+#endif // GUL17_PARALLEL_H_
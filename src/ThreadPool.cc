@@ -24,7 +24,11 @@
  */
 
 #include <algorithm>
+#include <cstdio>
 #include <limits>
+#include <ostream>
+#include <string>
+#include <system_error>
 
 #include <gul17/cat.h>
 #include <gul17/ThreadPool.h>
@@ -32,8 +36,102 @@
 
 #include <signal.h>
 
+#if defined(__APPLE__) || defined(__GNUC__)
+#   include <pthread.h>
+#   include <sched.h>
+#endif
+
 namespace gul17 {
 
+namespace {
+
+#if defined(__APPLE__) || defined(__GNUC__)
+
+int get_native_scheduling_policy(ThreadSchedulingPolicy policy)
+{
+    switch (policy)
+    {
+    case ThreadSchedulingPolicy::fifo:
+        return SCHED_FIFO;
+    case ThreadSchedulingPolicy::round_robin:
+        return SCHED_RR;
+    default:
+        return SCHED_OTHER;
+    }
+}
+
+#endif
+
+/// Return a string as a quoted JSON string literal.
+std::string to_json_string(const std::string& str)
+{
+    std::string result;
+    result.reserve(str.size() + 2);
+    result += '"';
+
+    for (const char c : str)
+    {
+        switch (c)
+        {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+                result += buf;
+            }
+            else
+            {
+                result += c;
+            }
+        }
+    }
+
+    result += '"';
+    return result;
+}
+
+/// Format a duration as a number of microseconds with three decimals.
+std::string to_microseconds(std::chrono::steady_clock::duration duration)
+{
+    const auto ns = std::max<std::int64_t>(0,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%lld.%03lld",
+        static_cast<long long>(ns / 1000), static_cast<long long>(ns % 1000));
+    return buf;
+}
+
+/// Return the numbers of all CPUs on which the process is allowed to run.
+std::vector<int> get_available_cpus()
+{
+    std::vector<int> cpus;
+
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+    {
+        for (int cpu = 0; cpu != CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &cpu_set))
+                cpus.push_back(cpu);
+        }
+    }
+#endif
+
+    return cpus;
+}
+
+} // anonymous namespace
+
 namespace detail {
 
 std::shared_ptr<ThreadPool> lock_pool_or_throw(std::weak_ptr<ThreadPool> pool)
@@ -52,21 +150,112 @@ std::shared_ptr<ThreadPool> lock_pool_or_throw(std::weak_ptr<ThreadPool> pool)
 // ThreadPool
 //
 
-ThreadPool::ThreadPool(std::size_t num_threads, std::size_t capacity)
-    : capacity_(capacity)
+ThreadPool::ThreadPool(const Options& options)
+    : capacity_(options.capacity)
+    , work_stealing_(options.work_stealing)
+    , priority_aging_(options.priority_aging)
+    , min_num_threads_(options.num_threads)
+    , max_num_threads_(options.max_num_threads ? options.max_num_threads
+                                               : options.num_threads)
+    , spawn_latency_(options.spawn_latency)
+    , keep_alive_(options.keep_alive)
+    , thread_name_(options.thread_name)
+    , scheduling_policy_(options.scheduling_policy)
+    , scheduling_priority_(options.scheduling_priority)
+    , spin_time_(options.spin_time)
 {
-    if (num_threads == 0 || num_threads > max_threads)
+    if (min_num_threads_ == 0 || min_num_threads_ > max_threads)
     {
         throw std::invalid_argument(
-            cat("Illegal number of threads for thread pool: ", num_threads));
+            cat("Illegal number of threads for thread pool: ", min_num_threads_));
+    }
+
+    if (max_num_threads_ < min_num_threads_ || max_num_threads_ > max_threads)
+    {
+        throw std::invalid_argument(cat("Illegal maximum number of threads for thread "
+            "pool: ", max_num_threads_));
+    }
+
+    if (is_scaling())
+    {
+        if (spawn_latency_ < spawn_latency_.zero())
+            throw std::invalid_argument("Spawn latency must not be negative");
+        if (keep_alive_ <= keep_alive_.zero())
+            throw std::invalid_argument("Keep-alive time must be positive");
+    }
+
+    if (capacity_ == 0 || capacity_ > max_capacity)
+        throw std::invalid_argument(cat("Illegal capacity for thread pool: ", capacity_));
+
+    if (options.priority_aging < Duration::zero())
+        throw std::invalid_argument("Priority aging interval must not be negative");
+
+    if (options.spin_time < Duration::zero())
+        throw std::invalid_argument("Spin time must not be negative");
+
+    if (options.pin_threads)
+    {
+        for (const int cpu : options.cpus)
+        {
+#if defined(__linux__)
+            if (cpu < 0 || cpu >= CPU_SETSIZE)
+#else
+            if (cpu < 0)
+#endif
+                throw std::invalid_argument(cat("Illegal CPU number: ", cpu));
+        }
+
+        cpus_ = options.cpus.empty() ? get_available_cpus() : options.cpus;
+    }
+
+#if defined(__APPLE__) || defined(__GNUC__)
+    if (scheduling_policy_ != ThreadSchedulingPolicy::inherit)
+    {
+        const int policy = get_native_scheduling_policy(scheduling_policy_);
+        if (scheduling_priority_ < sched_get_priority_min(policy)
+            || scheduling_priority_ > sched_get_priority_max(policy))
+        {
+            throw std::invalid_argument(cat("Illegal scheduling priority: ",
+                scheduling_priority_));
+        }
+    }
+#endif
+
+    thread_cpus_ = std::vector<std::atomic<int>>(max_num_threads_);
+    for (auto& cpu : thread_cpus_)
+        cpu = -1;
+
+    if (options.collect_metrics)
+    {
+        thread_metrics_.reserve(max_num_threads_);
+        for (std::size_t i = 0; i != max_num_threads_; ++i)
+            thread_metrics_.push_back(std::make_unique<ThreadMetrics>());
+    }
+
+    if (options.trace_capacity != 0)
+    {
+        traces_.reserve(max_num_threads_);
+        for (std::size_t i = 0; i != max_num_threads_; ++i)
+        {
+            traces_.push_back(std::make_unique<TraceBuffer>());
+            traces_.back()->events_.resize(options.trace_capacity);
+        }
     }
 
-    if (capacity == 0 || capacity > max_capacity)
-        throw std::invalid_argument(cat("Illegal capacity for thread pool: ", capacity));
+    workers_.reserve(max_num_threads_);
+    for (std::size_t i = 0; i != max_num_threads_; ++i)
+        workers_.push_back(std::make_unique<Worker>());
 
-    threads_.reserve(num_threads);
-    for (std::size_t i = 0; i != num_threads; ++i)
-        threads_.emplace_back([this, i]() { perform_work(i); });
+    threads_.resize(max_num_threads_);
+    is_thread_active_.resize(max_num_threads_, false);
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    for (std::size_t i = 0; i != min_num_threads_; ++i)
+    {
+        is_thread_active_[i] = true;
+        ++num_threads_;
+        threads_[i] = std::thread([this, i]() { perform_work(i); });
+    }
 }
 
 ThreadPool::~ThreadPool()
@@ -76,210 +265,1753 @@ ThreadPool::~ThreadPool()
     lock.unlock();
     cv_.notify_all();
 
-    for (auto& t : threads_)
-    {
-        if (t.joinable())
-            t.join();
-    }
+    join_threads();
 }
 
 bool ThreadPool::cancel_pending_task(const TaskId task_id)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Destroying the task breaks its promise before the tasks waiting for it are released.
+    // The destructor runs without the lock because it may call back into the pool.
+    const auto destroy_and_release_dependents = [this, task_id, &lock](Task& task)
+        {
+            lock.unlock();
+            task = Task{};
+            lock.lock();
+
+            if (not thread_metrics_.empty())
+                ++num_canceled_;
+
+            const auto num_wakeups = claim_wakeups_i(release_dependents_i(task_id));
+            notify_idle_waiters_i();
+            lock.unlock();
+            notify_workers(num_wakeups);
+        };
+
+    auto it = slot_index_.find(task_id);
+    if (it != slot_index_.end())
+    {
+        auto task = take_task_i(it->second);
+        release_pending_slots();
+        destroy_and_release_dependents(task);
+        return true;
+    }
 
-    auto it = std::find_if(pending_tasks_.begin(), pending_tasks_.end(),
-        [task_id](const Task& t) { return t.id_ == task_id; });
-    if (it != pending_tasks_.end())
+    auto itb = blocked_tasks_.find(task_id);
+    if (itb != blocked_tasks_.end())
     {
-        pending_tasks_.erase(it);
+        auto task = std::move(itb->second.task_);
+        blocked_tasks_.erase(itb);
+        release_pending_slots();
+        destroy_and_release_dependents(task);
         return true;
     }
 
+    for (auto& worker : workers_)
+    {
+        std::unique_lock<std::mutex> worker_lock(worker->mutex_);
+
+        auto& tasks = worker->local_tasks_;
+        auto itl = std::find_if(tasks.begin(), tasks.end(),
+            [task_id](const Task& t) { return t.id_ == task_id; });
+        if (itl != tasks.end())
+        {
+            auto task = std::move(*itl);
+            tasks.erase(itl);
+            --num_local_tasks_;
+            release_pending_slots();
+            worker_lock.unlock();
+            destroy_and_release_dependents(task);
+            return true;
+        }
+    }
+
     return false;
 }
 
 std::size_t ThreadPool::cancel_pending_tasks()
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // The tasks are moved out of the queues and destroyed after all locks have been
+    // released because their destructors may call back into the pool.
+    std::vector<Task> removed_tasks;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto worker_locks = lock_workers();
 
-    std::size_t num_removed = pending_tasks_.size();
-    pending_tasks_.clear();
+    std::size_t num_removed = task_slots_.size() - free_slots_.size();
+    removed_tasks.reserve(task_slots_.size() + blocked_tasks_.size());
+    for (auto& task_slot : task_slots_)
+        removed_tasks.push_back(std::move(task_slot.task_));
+    task_slots_.clear();
+    free_slots_.clear();
+    slot_index_.clear();
+    scheduled_tasks_.clear();
+    ready_lists_.fill(ReadyList{});
+    num_ready_high_priority_tasks_ = 0;
+
+    num_removed += blocked_tasks_.size();
+    for (auto& blocked_task : blocked_tasks_)
+        removed_tasks.push_back(std::move(blocked_task.second.task_));
+    blocked_tasks_.clear();
+    dependents_.clear();
+    num_awaited_tasks_ = 0;
+
+    for (auto& worker : workers_)
+    {
+        num_local_tasks_ -= worker->local_tasks_.size();
+        num_removed += worker->local_tasks_.size();
+        for (auto& task : worker->local_tasks_)
+            removed_tasks.push_back(std::move(task));
+        worker->local_tasks_.clear();
+    }
+
+    release_pending_slots(num_removed);
+
+    if (not thread_metrics_.empty())
+        num_canceled_ += num_removed;
+
+    worker_locks.clear();
+    lock.unlock();
+
+    removed_tasks.clear();
+
+    lock.lock();
+    notify_idle_waiters_i();
 
     return num_removed;
 }
 
 std::size_t ThreadPool::count_pending() const
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return pending_tasks_.size();
+    return num_pending_;
 }
 
 std::size_t ThreadPool::count_threads() const noexcept
 {
-    return threads_.size();
+    return num_threads_;
 }
 
-std::vector<std::string> ThreadPool::get_pending_task_names() const
+void ThreadPool::check_queue_latency_i(const SteadyTimePoint ready_since)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-
-    std::vector<std::string> names;
-    names.resize(pending_tasks_.size());
-
-    std::transform(pending_tasks_.begin(), pending_tasks_.end(), names.begin(),
-        [](const Task& t) { return t.named_task_->name_; });
+    if (num_sleeping_ != 0 || num_threads_ >= max_num_threads_ || spawn_requested_)
+        return;
 
-    return names;
-}
+    if (ready_since == SteadyTimePoint::max()
+        || std::chrono::steady_clock::now() - ready_since < spawn_latency_)
+    {
+        return;
+    }
 
-std::vector<std::string> ThreadPool::get_running_task_names() const
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    return running_task_names_;
+    spawn_requested_ = true;
 }
 
-ThreadPool::InternalTaskState ThreadPool::get_task_state(const TaskId task_id) const
+ThreadPool::TaskId ThreadPool::enqueue_task(Task task)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
+    TaskId id;
 
-    const auto itr = std::find(
-        running_task_ids_.begin(), running_task_ids_.end(), task_id);
-    if (itr != running_task_ids_.end())
-        return InternalTaskState::running;
+    if (not try_enqueue_task(task, id))
+    {
+        if (shutdown_requested_)
+            throw std::runtime_error("Cannot add task: Thread pool has been shut down");
 
-    const auto itp = std::find_if(
-        pending_tasks_.begin(), pending_tasks_.end(),
-        [task_id](const Task& t) { return t.id_ == task_id; });
-    if (itp != pending_tasks_.end())
-        return InternalTaskState::pending;
+        throw std::runtime_error(cat(
+            "Cannot add task: Pending queue has reached capacity (", capacity_, ')'));
+    }
 
-    return InternalTaskState::unknown;
+    return id;
 }
 
-ThreadPool::ThreadId ThreadPool::get_thread_id() const
+bool ThreadPool::enqueue_task_wait(Task& task, TaskId& id, SteadyTimePoint deadline)
 {
-    if (thread_id_ == std::numeric_limits<ThreadId>::max())
-        throw std::runtime_error("This thread is not part of the pool");
+    while (not try_enqueue_task(task, id))
+    {
+        if (shutdown_requested_)
+            throw std::runtime_error("Cannot add task: Thread pool has been shut down");
 
-    return thread_id_;
-}
+        if (not wait_for_space(deadline))
+            return false;
+    }
 
-bool ThreadPool::is_full() const noexcept
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    return is_full_i();
+    return true;
 }
 
-bool ThreadPool::is_full_i() const noexcept
+bool ThreadPool::try_enqueue_task(Task& task, TaskId& id)
 {
-    return pending_tasks_.size() >= capacity_;
-}
+    if (work_stealing_ && current_pool_ == this && task.start_time_ == SteadyTimePoint{}
+        && task.priority_ == TaskPriority::normal)
+    {
+        auto& worker = *workers_[thread_id_];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex_);
 
-bool ThreadPool::is_idle() const
-{
-    std::lock_guard<std::mutex> lock(mutex_);
-    return pending_tasks_.empty() && running_task_ids_.empty();
+            if (not try_reserve_pending_slots())
+                return false;
+
+            id = next_task_id_++;
+            task.id_ = id;
+            if (needs_enqueue_time())
+                task.enqueue_time_ = std::chrono::steady_clock::now();
+            worker.local_tasks_.push_back(std::move(task));
+            ++num_local_tasks_;
+        }
+
+        // The owning thread is busy with the current task, so let somebody else steal
+        // the new one.
+        wake_sleeping_workers();
+        return true;
+    }
+
+    std::size_t num_wakeups;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (not try_reserve_pending_slots())
+            return false;
+
+        id = next_task_id_++;
+        task.id_ = id;
+        push_task_i(std::move(task));
+
+        if (is_scaling())
+            check_queue_latency_i(get_oldest_ready_time_i());
+
+        num_wakeups = claim_wakeups_i(1);
+    }
+
+    notify_workers(num_wakeups);
+
+    if (spawn_requested_)
+        spawn_worker();
+
+    return true;
 }
 
-bool ThreadPool::is_shutdown_requested() const
+ThreadPool::TaskId ThreadPool::enqueue_tasks(std::vector<Task>& tasks)
 {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return shutdown_requested_;
+    const auto num_tasks = tasks.size();
+    TaskId first_id;
+
+    if (work_stealing_ && current_pool_ == this)
+    {
+        auto& worker = *workers_[thread_id_];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex_);
+
+            reserve_pending_slots(num_tasks);
+            first_id = next_task_id_.fetch_add(num_tasks);
+
+            // The owner pops from the back, so push in reverse order to run the first
+            // task first.
+            const auto now = needs_enqueue_time()
+                ? std::chrono::steady_clock::now() : SteadyTimePoint{};
+
+            for (std::size_t i = num_tasks; i-- != 0;)
+            {
+                tasks[i].id_ = first_id + i;
+                tasks[i].enqueue_time_ = now;
+                worker.local_tasks_.push_back(std::move(tasks[i]));
+            }
+            num_local_tasks_ += num_tasks;
+        }
+
+        // The owning thread is busy with the current task, so let the others steal.
+        wake_sleeping_workers(num_tasks);
+
+        return first_id;
+    }
+
+    std::size_t num_wakeups;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        reserve_pending_slots(num_tasks);
+        first_id = next_task_id_.fetch_add(num_tasks);
+
+        for (std::size_t i = 0; i != num_tasks; ++i)
+        {
+            tasks[i].id_ = first_id + i;
+            push_task_i(std::move(tasks[i]));
+        }
+
+        num_wakeups = claim_wakeups_i(num_tasks);
+    }
+
+    notify_workers(num_wakeups);
+
+    return first_id;
 }
 
-std::shared_ptr<ThreadPool> ThreadPool::make_shared(
-    std::size_t num_threads, std::size_t capacity)
+ThreadPool::TaskId
+ThreadPool::enqueue_task_after(Task task, const std::vector<TaskId>& predecessors)
 {
-    // We cannot use std::make_shared() because the constructor is private.
-    return std::shared_ptr<ThreadPool>(new ThreadPool(num_threads, capacity));
+    TaskId id;
+    std::size_t num_wakeups = 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const auto worker_locks = lock_workers();
+
+        reserve_pending_slots();
+        id = next_task_id_++;
+        task.id_ = id;
+
+        std::size_t num_predecessors = 0;
+        for (const auto predecessor : predecessors)
+        {
+            if (get_task_state_i(predecessor) == InternalTaskState::unknown)
+                continue; // already finished
+
+            dependents_[predecessor].push_back(id);
+            ++num_predecessors;
+        }
+
+        if (num_predecessors == 0)
+        {
+            push_task_i(std::move(task));
+            num_wakeups = claim_wakeups_i(1);
+        }
+        else
+        {
+            blocked_tasks_.emplace(id, BlockedTask{ std::move(task), num_predecessors });
+            num_awaited_tasks_ = dependents_.size();
+        }
+    }
+
+    notify_workers(num_wakeups);
+
+    return id;
 }
 
-void ThreadPool::perform_work(const ThreadPool::ThreadId thread_id)
+std::vector<ThreadPool::TaskHandle<void>> ThreadPool::add_task_graph(TaskGraph graph)
 {
-#if defined(__APPLE__) || defined(__GNUC__)
-    // On unixoid systems, we block a number of signals in the worker threads because we
-    // do not explicitly handle them. Otherwise, a worker thread receiving a signal might
-    // terminate the whole process.
+    const auto num_tasks = graph.nodes_.size();
 
-    sigset_t mask;
+    std::vector<TaskHandle<void>> handles;
+    if (num_tasks == 0)
+        return handles;
 
-    sigemptyset(&mask);
-    sigaddset(&mask, SIGALRM);
-    sigaddset(&mask, SIGINT);
-    sigaddset(&mask, SIGPIPE);
-    sigaddset(&mask, SIGTERM);
-    sigaddset(&mask, SIGURG);
-    sigaddset(&mask, SIGUSR1);
-    sigaddset(&mask, SIGUSR2);
+    handles.reserve(num_tasks);
 
-    pthread_sigmask(SIG_BLOCK, &mask, 0);
-#endif
+    TaskId first_id;
+    std::size_t num_ready = 0;
+    std::size_t num_wakeups;
 
-    // Assign thread-local thread ID
-    thread_id_ = thread_id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
 
-    std::unique_lock<std::mutex> lock(mutex_);
+        reserve_pending_slots(num_tasks);
+        first_id = next_task_id_.fetch_add(num_tasks);
 
-    while (!shutdown_requested_)
-    {
-        // mutex is locked
-        if (pending_tasks_.empty())
+        // All IDs are new, so no task of the graph can have finished yet
+        for (std::size_t i = 0; i != num_tasks; ++i)
         {
-            cv_.wait(lock); // acquires the lock when done
-            continue;
+            auto& node = graph.nodes_[i];
+            const TaskId id = first_id + i;
+            Task task{ id, std::move(node.named_task_), SteadyTimePoint{} };
+
+            if (node.dependencies_.empty())
+            {
+                push_task_i(std::move(task));
+                ++num_ready;
+                continue;
+            }
+
+            for (const auto dependency : node.dependencies_)
+                dependents_[first_id + dependency].push_back(id);
+
+            blocked_tasks_.emplace(
+                id, BlockedTask{ std::move(task), node.dependencies_.size() });
         }
 
-        const auto now = std::chrono::system_clock::now();
-        auto task_it = std::find_if(pending_tasks_.begin(), pending_tasks_.end(),
-            [now](const Task& t) { return t.start_time_ <= now; });
+        num_awaited_tasks_ = dependents_.size();
+        num_wakeups = claim_wakeups_i(num_ready);
+    }
 
-        if (task_it == pending_tasks_.end())
-        {
-            task_it = std::min_element(pending_tasks_.begin(), pending_tasks_.end(),
-                [](const Task& a, const Task& b) { return a.start_time_ < b.start_time_; });
+    notify_workers(num_wakeups);
 
-            // Note: We may not pass task_it->start_time_ directly to wait_until() because
-            // it may get invalidated when the mutex is unlocked.
-            const auto start_time = task_it->start_time_;
+    auto self = shared_from_this();
+    for (std::size_t i = 0; i != num_tasks; ++i)
+        handles.emplace_back(first_id + i, std::move(graph.nodes_[i].future_), self);
 
-            cv_.wait_until(lock, start_time); // acquires the lock when done
-            continue;
-        }
+    return handles;
+}
 
-        auto named_task_ptr = std::move(task_it->named_task_);
-        auto id = task_it->id_;
-        auto name = std::move(named_task_ptr->name_);
-        pending_tasks_.erase(task_it);
+void ThreadPool::count_task_exception() noexcept
+{
+    if (thread_metrics_.empty() || current_pool_ != this)
+        return;
 
-        running_task_ids_.push_back(id);
-        running_task_names_.push_back(name);
+    auto& counter = thread_metrics_[thread_id_]->num_failed_;
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
 
-        lock.unlock();
+void ThreadPool::execute_task(Task& task)
+{
+    if (thread_metrics_.empty())
+    {
+        const auto start_time = traces_.empty()
+            ? SteadyTimePoint{} : std::chrono::steady_clock::now();
 
         try
         {
-            (*named_task_ptr)(*this);
+            task(*this);
         }
         catch (...)
         {
-            // This should not happen because the packaged_task should catch all
-            // exceptions itself. But in case of something unexpected, we'll try
-            // to continue...
+            // Detached tasks may throw, all others catch their exceptions themselves.
         }
 
-        lock.lock();
+        if (not traces_.empty())
+            record_trace_event(task, start_time, std::chrono::steady_clock::now());
+        return;
+    }
 
-        auto it = std::find(running_task_ids_.begin(), running_task_ids_.end(), id);
-        if (it != running_task_ids_.end())
+    // Only this thread writes to its metrics, so there is no need for atomic increments
+    const auto increment = [](std::atomic<std::uint64_t>& counter)
         {
-            const auto idx = it - running_task_ids_.begin();
-            running_task_ids_.erase(it);
-            running_task_names_.erase(running_task_names_.begin() + idx);
-        }
+            counter.store(counter.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        };
+
+    auto& metrics = *thread_metrics_[thread_id_];
+
+    const auto start_time = std::chrono::steady_clock::now();
+    const auto ready_time = std::max(task.enqueue_time_, task.start_time_);
+    const auto queue_latency = start_time - ready_time;
+    increment(metrics.queue_latency_[DurationHistogram::get_bucket(queue_latency)]);
+
+    try
+    {
+        task(*this);
+    }
+    catch (...)
+    {
+        increment(metrics.num_failed_);
     }
+
+    const auto end_time = std::chrono::steady_clock::now();
+    const auto execution_time = end_time - start_time;
+
+    increment(metrics.execution_time_[DurationHistogram::get_bucket(execution_time)]);
+    increment(metrics.num_executed_);
+    metrics.busy_ns_.store(metrics.busy_ns_.load(std::memory_order_relaxed)
+        + std::chrono::duration_cast<std::chrono::nanoseconds>(execution_time).count(),
+        std::memory_order_relaxed);
+
+    if (not traces_.empty())
+        record_trace_event(task, start_time, end_time);
 }
 
-thread_local ThreadPool::ThreadId
-ThreadPool::thread_id_{ std::numeric_limits<ThreadPool::ThreadId>::max() };
+ThreadPool::Metrics ThreadPool::get_metrics() const
+{
+    if (thread_metrics_.empty())
+        throw std::logic_error("Metrics are not enabled for this thread pool");
+
+    Metrics result;
+    result.thread_busy_ratios.reserve(thread_metrics_.size());
+
+    const auto lifetime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - creation_time_).count();
+
+    std::uint64_t num_executed = 0;
+
+    for (const auto& metrics : thread_metrics_)
+    {
+        for (std::size_t i = 0; i != DurationHistogram::num_buckets; ++i)
+        {
+            result.queue_latency.counts[i] +=
+                metrics->queue_latency_[i].load(std::memory_order_relaxed);
+            result.execution_time.counts[i] +=
+                metrics->execution_time_[i].load(std::memory_order_relaxed);
+        }
+
+        num_executed += metrics->num_executed_.load(std::memory_order_relaxed);
+        result.num_failed += metrics->num_failed_.load(std::memory_order_relaxed);
+
+        const auto busy_ns = metrics->busy_ns_.load(std::memory_order_relaxed);
+        const auto ratio = lifetime_ns > 0
+            ? static_cast<double>(busy_ns) / static_cast<double>(lifetime_ns) : 0.0;
+        result.thread_busy_ratios.push_back(std::min(1.0, ratio));
+    }
+
+    // A task can be counted as failed before it is counted as executed
+    result.num_completed = num_executed > result.num_failed
+        ? num_executed - result.num_failed : 0;
+    result.num_canceled = num_canceled_.load(std::memory_order_relaxed);
+    result.max_pending = max_pending_.load(std::memory_order_relaxed);
+    result.num_wakeups = num_wakeups_.load(std::memory_order_relaxed);
+    result.num_wakeups_avoided = num_wakeups_avoided_.load(std::memory_order_relaxed);
+    result.num_spin_hits = num_spin_hits_.load(std::memory_order_relaxed);
+
+    return result;
+}
+
+std::vector<ThreadPool::TraceEvent> ThreadPool::get_trace() const
+{
+    if (traces_.empty())
+        throw std::logic_error("Tracing is not enabled for this thread pool");
+
+    std::vector<TraceEvent> events;
+
+    for (const auto& trace : traces_)
+    {
+        std::lock_guard<std::mutex> lock(trace->mutex_);
+
+        const auto& buffer = trace->events_;
+        const auto next = static_cast<std::ptrdiff_t>(trace->next_);
+
+        // Oldest events first
+        if (trace->is_full_)
+            events.insert(events.end(), buffer.begin() + next, buffer.end());
+        events.insert(events.end(), buffer.begin(), buffer.begin() + next);
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+        [](const TraceEvent& a, const TraceEvent& b)
+        {
+            return a.start_time < b.start_time;
+        });
+
+    return events;
+}
+
+std::vector<std::string> ThreadPool::get_pending_task_names() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto worker_locks = lock_workers();
+
+    std::vector<const Task*> tasks;
+    tasks.reserve(num_pending_);
+
+    for (const auto& list : ready_lists_)
+    {
+        for (auto slot = list.head_; slot != no_slot; slot = task_slots_[slot].next_)
+            tasks.push_back(&task_slots_[slot].task_);
+    }
+
+    for (const auto slot : scheduled_tasks_)
+        tasks.push_back(&task_slots_[slot].task_);
+
+    for (const auto& entry : blocked_tasks_)
+        tasks.push_back(&entry.second.task_);
+
+    // Local queues are only used in work-stealing mode
+    for (const auto& worker : workers_)
+    {
+        for (const auto& task : worker->local_tasks_)
+            tasks.push_back(&task);
+    }
+
+    // Report the tasks in the order in which they were added
+    std::sort(tasks.begin(), tasks.end(),
+        [](const Task* a, const Task* b) { return a->id_ < b->id_; });
+
+    std::vector<std::string> names;
+    names.resize(tasks.size());
+
+    // Detached tasks have no name
+    std::transform(tasks.begin(), tasks.end(), names.begin(),
+        [](const Task* t)
+        {
+            return t->is_detached() ? std::string{} : t->named_task_->name_;
+        });
+
+    return names;
+}
+
+std::vector<std::string> ThreadPool::get_running_task_names() const
+{
+    std::vector<std::string> names;
+
+    // Only the lock of each worker is needed, not the global one
+    for (const auto& worker : workers_)
+    {
+        std::lock_guard<std::mutex> lock(worker->mutex_);
+        // A finishing task has already dropped its name
+        if (not worker->is_running_task_ || worker->is_finishing_task_)
+            continue;
+
+        if (worker->running_task_name_)
+            names.push_back(*worker->running_task_name_);
+        else
+            names.emplace_back(); // Detached tasks have no name
+    }
+
+    return names;
+}
+
+ThreadPool::InternalTaskState ThreadPool::get_task_state(const TaskId task_id) const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto worker_locks = lock_workers();
+
+    return get_task_state_i(task_id);
+}
+
+ThreadPool::InternalTaskState ThreadPool::get_task_state_i(const TaskId task_id) const
+{
+    if (slot_index_.count(task_id) || blocked_tasks_.count(task_id))
+        return InternalTaskState::pending;
+
+    const auto has_id = [task_id](const Task& t) { return t.id_ == task_id; };
+
+    for (const auto& worker : workers_)
+    {
+        if (worker->is_running_task_ && worker->running_task_id_ == task_id)
+            return InternalTaskState::running;
+
+        const auto& tasks = worker->local_tasks_;
+        if (std::find_if(tasks.begin(), tasks.end(), has_id) != tasks.end())
+            return InternalTaskState::pending;
+    }
+
+    return InternalTaskState::unknown;
+}
+
+int ThreadPool::get_thread_cpu(const ThreadId thread_id) const
+{
+    if (thread_id >= thread_cpus_.size())
+        throw std::out_of_range(cat("Illegal thread ID: ", thread_id));
+
+    return thread_cpus_[thread_id];
+}
+
+ThreadPool::ThreadId ThreadPool::get_thread_id() const
+{
+    if (thread_id_ == std::numeric_limits<ThreadId>::max())
+        throw std::runtime_error("This thread is not part of the pool");
+
+    return thread_id_;
+}
+
+bool ThreadPool::is_full() const noexcept
+{
+    return is_full_i();
+}
+
+bool ThreadPool::is_full_i() const noexcept
+{
+    return num_pending_ >= capacity_;
+}
+
+bool ThreadPool::is_idle() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    const auto worker_locks = lock_workers();
+
+    return is_idle_i();
+}
+
+bool ThreadPool::is_idle_i() const
+{
+    if (num_pending_ != 0)
+        return false;
+
+    return std::none_of(workers_.begin(), workers_.end(),
+        [](const auto& worker) { return worker->is_running_task_; });
+}
+
+bool ThreadPool::is_shutdown_requested() const
+{
+    return shutdown_requested_;
+}
+
+bool ThreadPool::shutdown(const ShutdownMode mode, const Duration timeout)
+{
+    if (current_pool_ == this)
+        throw std::logic_error("Cannot shut down a thread pool from one of its threads");
+
+    const auto deadline = detail::get_deadline(timeout);
+    bool is_idle = false;
+
+    if (mode == ShutdownMode::drain)
+        is_idle = wait_idle_until(deadline);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_requested_ = true;
+    }
+    cv_.notify_all();
+
+    // Release producers that wait for space in the queue
+    {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+    }
+    space_cv_.notify_all();
+
+    // Whatever is left over after a timeout or has been added in the meantime
+    cancel_pending_tasks();
+
+    if (mode == ShutdownMode::discard)
+        is_idle = wait_idle_until(deadline);
+
+    if (not is_idle)
+        return false;
+
+    join_threads();
+    return true;
+}
+
+void ThreadPool::join_threads()
+{
+    // No threads are launched after the shutdown request, but threads may still be
+    // terminating on their own and need threads_mutex_ for that.
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> threads_lock(threads_mutex_);
+        threads.swap(threads_);
+    }
+
+    for (auto& t : threads)
+    {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+std::vector<std::unique_lock<std::mutex>> ThreadPool::lock_workers() const
+{
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(workers_.size());
+
+    for (const auto& worker : workers_)
+        locks.emplace_back(worker->mutex_);
+
+    return locks;
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::make_shared(
+    std::size_t num_threads, std::size_t capacity)
+{
+    Options options;
+    options.num_threads = num_threads;
+    options.capacity = capacity;
+
+    return make_shared(options);
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::make_shared(const Options& options)
+{
+    // We cannot use std::make_shared() because the constructor is private.
+    return std::shared_ptr<ThreadPool>(new ThreadPool(options));
+}
+
+void ThreadPool::perform_work(const ThreadPool::ThreadId thread_id)
+{
+#if defined(__APPLE__) || defined(__GNUC__)
+    // On unixoid systems, we block a number of signals in the worker threads because we
+    // do not explicitly handle them. Otherwise, a worker thread receiving a signal might
+    // terminate the whole process.
+
+    sigset_t mask;
+
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGALRM);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGPIPE);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGURG);
+    sigaddset(&mask, SIGUSR1);
+    sigaddset(&mask, SIGUSR2);
+
+    pthread_sigmask(SIG_BLOCK, &mask, 0);
+#endif
+
+    configure_worker_thread(thread_id);
+
+    // Assign thread-local thread ID
+    thread_id_ = thread_id;
+    current_pool_ = this;
+
+    if (work_stealing_)
+        perform_work_stealing(thread_id);
+    else
+        perform_work_shared_queue(thread_id);
+
+    thread_cpus_[thread_id] = -1;
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+    is_thread_active_[thread_id] = false;
+}
+
+void ThreadPool::configure_worker_thread(const ThreadId thread_id)
+{
+#if defined(__linux__)
+    if (not cpus_.empty())
+    {
+        const int cpu = cpus_[thread_id % cpus_.size()];
+
+        cpu_set_t cpu_set;
+        CPU_ZERO(&cpu_set);
+        CPU_SET(cpu, &cpu_set);
+
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0)
+            thread_cpus_[thread_id] = cpu;
+    }
+#endif
+
+#if defined(__linux__) || defined(__APPLE__)
+    if (not thread_name_.empty())
+    {
+        const std::string name = cat(thread_name_, thread_id).substr(0, 15);
+#   if defined(__APPLE__)
+        pthread_setname_np(name.c_str());
+#   else
+        pthread_setname_np(pthread_self(), name.c_str());
+#   endif
+    }
+#endif
+
+#if defined(__APPLE__) || defined(__GNUC__)
+    if (scheduling_policy_ != ThreadSchedulingPolicy::inherit)
+    {
+        sched_param param{};
+        param.sched_priority = scheduling_priority_;
+        pthread_setschedparam(pthread_self(),
+            get_native_scheduling_policy(scheduling_policy_), &param);
+    }
+#else
+    (void)thread_id;
+#endif
+}
+
+void ThreadPool::perform_work_shared_queue(const ThreadId thread_id)
+{
+    auto& worker = *workers_[thread_id];
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto idle_since = std::chrono::steady_clock::now();
+
+    while (!shutdown_requested_)
+    {
+        // mutex is locked
+        Task task;
+        if (not pop_ready_task_i(lock, task))
+        {
+            if (is_scaling() && retire_worker_i(idle_since))
+                break;
+            continue;
+        }
+
+        const auto id = task.id_;
+
+        {
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+            worker.start_task(task);
+        }
+
+        lock.unlock();
+
+        if (spawn_requested_)
+            spawn_worker();
+
+        execute_task(task);
+
+        // Destroy the task (and with it, any captured state) before taking the lock again
+        // because the destructor may call back into the pool. Periodic tasks are kept for
+        // requeueing. The name referenced by the worker goes away with the task, so it is
+        // dropped first.
+        const bool is_periodic = task.is_periodic();
+        if (not is_periodic)
+        {
+            {
+                std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+                worker.release_task_name();
+            }
+
+            task = Task{};
+        }
+
+        lock.lock();
+
+        if (is_scaling())
+            idle_since = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+            worker.finish_task();
+        }
+
+        const bool is_requeued = is_periodic && requeue_periodic_task_i(task);
+
+        if (not is_requeued && not dependents_.empty())
+        {
+            // This thread takes care of one of the released tasks itself
+            const auto num_ready = release_dependents_i(id);
+            if (num_ready > 1)
+                notify_workers(claim_wakeups_i(num_ready - 1));
+        }
+
+        notify_idle_waiters_i();
+
+        if (is_periodic && not is_requeued)
+        {
+            // A periodic task that has run for the last time is destroyed without the
+            // lock as well
+            lock.unlock();
+            task = Task{};
+            lock.lock();
+        }
+    }
+}
+
+void ThreadPool::perform_work_stealing(const ThreadId thread_id)
+{
+    auto& worker = *workers_[thread_id];
+    auto idle_since = std::chrono::steady_clock::now();
+
+    while (!shutdown_requested_)
+    {
+        Task task;
+
+        // High-priority tasks are only ever put into the shared queue
+        const bool has_task =
+            num_ready_high_priority_tasks_ != 0 && pop_shared_task(thread_id, task);
+
+        if (not has_task && not pop_local_task(thread_id, task)
+            && not steal_task(thread_id, task))
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (shutdown_requested_)
+                break;
+
+            if (not pop_ready_task_i(lock, task))
+            {
+                if (is_scaling() && retire_worker_i(idle_since))
+                    break;
+                continue;
+            }
+
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+            worker.start_task(task);
+        }
+
+        if (spawn_requested_)
+            spawn_worker();
+
+        execute_task(task);
+
+        if (is_scaling())
+            idle_since = std::chrono::steady_clock::now();
+
+        if (task.is_periodic())
+        {
+            // Requeue the task and report it as finished in one go, so that it is never
+            // seen as neither pending nor running.
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+
+            worker.finish_task();
+            requeue_periodic_task_i(task);
+            continue;
+        }
+
+        const auto id = task.id_;
+
+        // Destroy the task (and with it, any captured state) before reporting it as
+        // finished. The name referenced by the worker goes away with the task, so it is
+        // dropped first. The destructor runs without the lock because it may call back
+        // into the pool.
+        {
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+            worker.release_task_name();
+        }
+
+        task = Task{};
+
+        {
+            std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+            worker.finish_task();
+        }
+
+        if (num_awaited_tasks_ != 0 || num_idle_waiters_ != 0)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            const auto num_wakeups = claim_wakeups_i(release_dependents_i(id));
+            notify_idle_waiters_i();
+            lock.unlock();
+
+            notify_workers(num_wakeups);
+        }
+    }
+}
+
+bool ThreadPool::pop_local_task(const ThreadId thread_id, Task& task)
+{
+    if (num_local_tasks_ == 0)
+        return false;
+
+    auto& worker = *workers_[thread_id];
+
+    std::lock_guard<std::mutex> lock(worker.mutex_);
+
+    if (worker.local_tasks_.empty())
+        return false;
+
+    task = std::move(worker.local_tasks_.back());
+    worker.local_tasks_.pop_back();
+    --num_local_tasks_;
+    release_pending_slots();
+
+    worker.start_task(task);
+
+    return true;
+}
+
+bool ThreadPool::pop_shared_task(const ThreadId thread_id, Task& task)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (not try_pop_ready_task_i(task))
+        return false;
+
+    auto& worker = *workers_[thread_id];
+    std::lock_guard<std::mutex> worker_lock(worker.mutex_);
+    worker.start_task(task);
+
+    return true;
+}
+
+bool ThreadPool::pop_ready_task_i(std::unique_lock<std::mutex>& lock, Task& task)
+{
+    if (try_pop_ready_task_i(task))
+        return true;
+
+    // The earliest time at which a task becomes ready (max() if there is no task)
+    auto wakeup_time = SteadyTimePoint::max();
+    if (not scheduled_tasks_.empty())
+        wakeup_time = task_slots_[scheduled_tasks_.front()].task_.start_time_;
+
+    // Threads that may terminate wake up when their keep-alive time might be exceeded
+    if (is_scaling() && num_threads_ > min_num_threads_)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        if (keep_alive_ < SteadyTimePoint::max() - now)
+            wakeup_time = std::min(wakeup_time, now + keep_alive_);
+    }
+
+    // Poll for a while before going to sleep, unless a delayed task is due anyway
+    if (spin_time_ != spin_time_.zero()
+        && wakeup_time > std::chrono::steady_clock::now() + spin_time_)
+    {
+        const std::size_t num_pending = num_pending_;
+
+        lock.unlock();
+        const bool has_work = spin_for_work(num_pending);
+        lock.lock();
+
+        if (has_work)
+        {
+            if (not thread_metrics_.empty())
+                num_spin_hits_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    // Announce that we are going to sleep before checking the local queues one last
+    // time. Together with wake_sleeping_workers(), this ensures that no wakeup is lost.
+    ++num_sleeping_;
+
+    if (num_local_tasks_ == 0)
+    {
+        if (wakeup_time == SteadyTimePoint::max())
+            cv_.wait(lock); // acquires the lock when done
+        else
+            cv_.wait_until(lock, wakeup_time); // acquires the lock when done
+    }
+
+    --num_sleeping_;
+
+    // We may have woken up for another reason than a notification, but the sleeping
+    // threads are indistinguishable, so any of them can consume it.
+    if (num_signaled_ != 0)
+        --num_signaled_;
+
+    return false;
+}
+
+bool ThreadPool::try_pop_ready_task_i(Task& task)
+{
+    if (not scheduled_tasks_.empty())
+        promote_due_tasks_i(std::chrono::steady_clock::now());
+
+    const auto slot = select_ready_slot_i();
+    if (slot == no_slot)
+        return false;
+
+    const auto ready_since = task_slots_[slot].ready_since_;
+
+    task = take_task_i(slot);
+    release_pending_slots();
+
+    // If more tasks are waiting, all threads are busy, and the queue latency is too high,
+    // ask for reinforcement.
+    if (is_scaling() && select_ready_slot_i() != no_slot)
+        check_queue_latency_i(ready_since);
+
+    return true;
+}
+
+ThreadPool::SteadyTimePoint ThreadPool::get_oldest_ready_time_i() const
+{
+    auto oldest = SteadyTimePoint::max();
+
+    for (const auto& list : ready_lists_)
+    {
+        if (list.head_ != no_slot)
+            oldest = std::min(oldest, task_slots_[list.head_].ready_since_);
+    }
+
+    return oldest;
+}
+
+ThreadPool::SlotIndex ThreadPool::select_ready_slot_i() const
+{
+    SlotIndex best_slot = no_slot;
+    std::size_t best_level = 0;
+    SteadyTimePoint now{};
+
+    // Go from the highest to the lowest priority, so ties are won by the higher one
+    for (std::size_t priority = num_priorities; priority-- != 0;)
+    {
+        const auto slot = ready_lists_[priority].head_;
+        if (slot == no_slot)
+            continue;
+
+        if (priority_aging_ == priority_aging_.zero())
+            return slot;
+
+        if (best_slot == no_slot)
+        {
+            best_slot = slot;
+            best_level = priority;
+            continue;
+        }
+
+        if (now == SteadyTimePoint{})
+        {
+            now = std::chrono::steady_clock::now();
+            best_level += static_cast<std::size_t>(
+                (now - task_slots_[best_slot].ready_since_) / priority_aging_);
+        }
+
+        const auto level = priority + static_cast<std::size_t>(
+            (now - task_slots_[slot].ready_since_) / priority_aging_);
+
+        if (level > best_level)
+        {
+            best_slot = slot;
+            best_level = level;
+        }
+    }
+
+    return best_slot;
+}
+
+void ThreadPool::promote_due_tasks_i(const SteadyTimePoint now)
+{
+    while (not scheduled_tasks_.empty())
+    {
+        const auto slot = scheduled_tasks_.front();
+        if (task_slots_[slot].task_.start_time_ > now)
+            break;
+
+        scheduled_tasks_.front() = scheduled_tasks_.back();
+        task_slots_[scheduled_tasks_.front()].heap_pos_ = 0;
+        scheduled_tasks_.pop_back();
+        if (not scheduled_tasks_.empty())
+            scheduled_sift_down_i(0);
+
+        task_slots_[slot].heap_pos_ = no_slot;
+        task_slots_[slot].ready_since_ = task_slots_[slot].task_.start_time_;
+        push_ready_slot_i(slot);
+    }
+}
+
+void ThreadPool::push_ready_slot_i(const SlotIndex slot)
+{
+    auto& task_slot = task_slots_[slot];
+    const auto priority = task_slot.task_.priority_;
+    auto& list = ready_lists_[static_cast<std::size_t>(priority)];
+
+    task_slot.prev_ = list.tail_;
+    task_slot.next_ = no_slot;
+
+    if (list.tail_ == no_slot)
+        list.head_ = slot;
+    else
+        task_slots_[list.tail_].next_ = slot;
+
+    list.tail_ = slot;
+
+    if (priority == TaskPriority::high)
+        ++num_ready_high_priority_tasks_;
+}
+
+void ThreadPool::push_task_i(Task task)
+{
+    SlotIndex slot;
+
+    if (free_slots_.empty())
+    {
+        slot = task_slots_.size();
+        task_slots_.emplace_back();
+    }
+    else
+    {
+        slot = free_slots_.back();
+        free_slots_.pop_back();
+    }
+
+    if (not task.is_detached())
+        slot_index_.emplace(task.id_, slot);
+
+    if (needs_enqueue_time())
+        task.enqueue_time_ = std::chrono::steady_clock::now();
+
+    const bool is_scheduled = task.start_time_ != SteadyTimePoint{}
+        && task.start_time_ > std::chrono::steady_clock::now();
+
+    task_slots_[slot].task_ = std::move(task);
+
+    if (is_scheduled)
+    {
+        task_slots_[slot].heap_pos_ = scheduled_tasks_.size();
+        scheduled_tasks_.push_back(slot);
+        scheduled_sift_up_i(scheduled_tasks_.size() - 1);
+    }
+    else
+    {
+        if (priority_aging_ != priority_aging_.zero() || is_scaling())
+            task_slots_[slot].ready_since_ = std::chrono::steady_clock::now();
+
+        push_ready_slot_i(slot);
+    }
+}
+
+bool ThreadPool::requeue_periodic_task_i(Task& task)
+{
+    // After a shutdown request, periodic tasks finish with their current execution
+    if (not task.is_periodic() || shutdown_requested_
+        || not task.named_task_->reschedule(task.start_time_))
+    {
+        return false;
+    }
+
+    // A periodic task keeps its slot in the queue even if the capacity has been reached
+    // in the meantime.
+    ++num_pending_;
+    push_task_i(std::move(task));
+
+    return true;
+}
+
+std::size_t ThreadPool::release_dependents_i(const TaskId task_id)
+{
+    const auto it = dependents_.find(task_id);
+    if (it == dependents_.end())
+        return 0;
+
+    const auto dependents = std::move(it->second);
+    dependents_.erase(it);
+    num_awaited_tasks_ = dependents_.size();
+
+    std::size_t num_ready = 0;
+
+    for (const auto dependent : dependents)
+    {
+        auto itb = blocked_tasks_.find(dependent);
+        if (itb == blocked_tasks_.end())
+            continue; // canceled
+
+        if (--itb->second.num_predecessors_ != 0)
+            continue;
+
+        push_task_i(std::move(itb->second.task_));
+        blocked_tasks_.erase(itb);
+        ++num_ready;
+    }
+
+    return num_ready;
+}
+
+void ThreadPool::record_trace_event(const Task& task, const SteadyTimePoint start_time,
+    const SteadyTimePoint end_time)
+{
+    auto& trace = *traces_[thread_id_];
+    std::lock_guard<std::mutex> lock(trace.mutex_);
+
+    // Assigning to an existing event reuses the memory of its name
+    auto& event = trace.events_[trace.next_];
+    event.task_id = task.id_;
+    if (const auto* name = task.get_name())
+        event.name = *name;
+    else
+        event.name.clear();
+    event.thread_id = thread_id_;
+    event.enqueue_time = task.enqueue_time_;
+    event.start_time = start_time;
+    event.end_time = end_time;
+
+    if (++trace.next_ == trace.events_.size())
+    {
+        trace.next_ = 0;
+        trace.is_full_ = true;
+    }
+}
+
+void ThreadPool::release_pending_slots(const std::size_t num_slots)
+{
+    num_pending_ -= num_slots;
+
+    if (num_waiting_producers_ == 0)
+        return;
+
+    // Acquiring the mutex makes sure that a waiting producer has either not checked the
+    // number of pending tasks yet or is already waiting on the condition variable.
+    {
+        std::lock_guard<std::mutex> lock(space_mutex_);
+    }
+
+    if (num_slots == 1)
+        space_cv_.notify_one();
+    else
+        space_cv_.notify_all();
+}
+
+void ThreadPool::reserve_pending_slots(const std::size_t num_slots)
+{
+    if (try_reserve_pending_slots(num_slots))
+        return;
+
+    if (shutdown_requested_)
+        throw std::runtime_error("Cannot add task: Thread pool has been shut down");
+
+    const std::size_t num_pending = num_pending_;
+
+    if (num_pending >= capacity_)
+    {
+        throw std::runtime_error(cat(
+            "Cannot add task: Pending queue has reached capacity (", num_pending, ')'));
+    }
+
+    throw std::runtime_error(cat("Cannot add ", num_slots,
+        " tasks: Pending queue has only room for ", capacity_ - num_pending));
+}
+
+bool ThreadPool::try_reserve_pending_slots(const std::size_t num_slots) noexcept
+{
+    if (shutdown_requested_)
+        return false;
+
+    auto num_pending = num_pending_.load();
+
+    do
+    {
+        if (num_pending >= capacity_ || num_slots > capacity_ - num_pending)
+            return false;
+    }
+    while (not num_pending_.compare_exchange_weak(num_pending, num_pending + num_slots));
+
+    if (not thread_metrics_.empty())
+    {
+        const auto new_num_pending = num_pending + num_slots;
+        auto max_pending = max_pending_.load(std::memory_order_relaxed);
+        while (new_num_pending > max_pending
+            && not max_pending_.compare_exchange_weak(max_pending, new_num_pending,
+                std::memory_order_relaxed))
+        {}
+    }
+
+    return true;
+}
+
+void ThreadPool::scheduled_sift_down_i(std::size_t pos)
+{
+    const auto size = scheduled_tasks_.size();
+    const auto slot = scheduled_tasks_[pos];
+
+    for (;;)
+    {
+        auto child = 2 * pos + 1;
+        if (child >= size)
+            break;
+
+        if (child + 1 < size
+            && starts_before_i(scheduled_tasks_[child + 1], scheduled_tasks_[child]))
+        {
+            ++child;
+        }
+
+        if (not starts_before_i(scheduled_tasks_[child], slot))
+            break;
+
+        scheduled_tasks_[pos] = scheduled_tasks_[child];
+        task_slots_[scheduled_tasks_[pos]].heap_pos_ = pos;
+        pos = child;
+    }
+
+    scheduled_tasks_[pos] = slot;
+    task_slots_[slot].heap_pos_ = pos;
+}
+
+void ThreadPool::scheduled_sift_up_i(std::size_t pos)
+{
+    const auto slot = scheduled_tasks_[pos];
+
+    while (pos > 0)
+    {
+        const auto parent = (pos - 1) / 2;
+        if (not starts_before_i(slot, scheduled_tasks_[parent]))
+            break;
+
+        scheduled_tasks_[pos] = scheduled_tasks_[parent];
+        task_slots_[scheduled_tasks_[pos]].heap_pos_ = pos;
+        pos = parent;
+    }
+
+    scheduled_tasks_[pos] = slot;
+    task_slots_[slot].heap_pos_ = pos;
+}
+
+bool ThreadPool::starts_before_i(const SlotIndex a, const SlotIndex b) const noexcept
+{
+    const auto& task_a = task_slots_[a].task_;
+    const auto& task_b = task_slots_[b].task_;
+
+    if (task_a.start_time_ != task_b.start_time_)
+        return task_a.start_time_ < task_b.start_time_;
+
+    return task_a.id_ < task_b.id_;
+}
+
+bool ThreadPool::steal_task(const ThreadId thread_id, Task& task)
+{
+    const auto num_threads = workers_.size();
+    auto& thief = *workers_[thread_id];
+
+    for (std::size_t i = 1; i < num_threads && num_local_tasks_ != 0; ++i)
+    {
+        const auto victim_id = (thread_id + i) % num_threads;
+        auto& victim = *workers_[victim_id];
+
+        // Lock both workers in the order of their IDs to avoid deadlocks
+        std::unique_lock<std::mutex> lock1(
+            victim_id < thread_id ? victim.mutex_ : thief.mutex_);
+        std::unique_lock<std::mutex> lock2(
+            victim_id < thread_id ? thief.mutex_ : victim.mutex_);
+
+        if (victim.local_tasks_.empty())
+            continue;
+
+        task = std::move(victim.local_tasks_.front());
+        victim.local_tasks_.pop_front();
+        --num_local_tasks_;
+        release_pending_slots();
+
+        thief.start_task(task);
+
+        return true;
+    }
+
+    return false;
+}
+
+ThreadPool::Task ThreadPool::take_task_i(const SlotIndex slot)
+{
+    auto& task_slot = task_slots_[slot];
+
+    if (task_slot.heap_pos_ != no_slot)
+    {
+        // Replace the element by the last one in the heap and move that one to the
+        // right position
+        const auto pos = task_slot.heap_pos_;
+        const auto last = scheduled_tasks_.back();
+        scheduled_tasks_.pop_back();
+
+        if (pos < scheduled_tasks_.size())
+        {
+            scheduled_tasks_[pos] = last;
+            task_slots_[last].heap_pos_ = pos;
+            scheduled_sift_up_i(pos);
+            scheduled_sift_down_i(task_slots_[last].heap_pos_);
+        }
+
+        task_slot.heap_pos_ = no_slot;
+    }
+    else
+    {
+        const auto priority = task_slot.task_.priority_;
+        auto& list = ready_lists_[static_cast<std::size_t>(priority)];
+
+        if (task_slot.prev_ == no_slot)
+            list.head_ = task_slot.next_;
+        else
+            task_slots_[task_slot.prev_].next_ = task_slot.next_;
+
+        if (task_slot.next_ == no_slot)
+            list.tail_ = task_slot.prev_;
+        else
+            task_slots_[task_slot.next_].prev_ = task_slot.prev_;
+
+        if (priority == TaskPriority::high)
+            --num_ready_high_priority_tasks_;
+    }
+
+    if (not task_slot.task_.is_detached())
+        slot_index_.erase(task_slot.task_.id_);
+    free_slots_.push_back(slot);
+
+    return std::move(task_slot.task_);
+}
+
+bool ThreadPool::wait_for_space(const SteadyTimePoint deadline)
+{
+    std::unique_lock<std::mutex> lock(space_mutex_);
+
+    const auto has_space =
+        [this]() { return num_pending_ < capacity_ || shutdown_requested_; };
+
+    // Announce the waiting producer before checking the number of pending tasks.
+    // Together with release_pending_slots(), this ensures that no wakeup is lost.
+    ++num_waiting_producers_;
+
+    bool result = true;
+
+    if (deadline == SteadyTimePoint::max())
+        space_cv_.wait(lock, has_space);
+    else
+        result = space_cv_.wait_until(lock, deadline, has_space);
+
+    --num_waiting_producers_;
+
+    return result;
+}
+
+void ThreadPool::write_chrome_trace(std::ostream& out) const
+{
+    const auto events = get_trace();
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    const char* separator = "\n";
+
+    for (ThreadId i = 0; i != traces_.size(); ++i)
+    {
+        const auto thread_name = thread_name_.empty()
+            ? cat("worker ", i) : cat(thread_name_, i);
+
+        out << separator << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << i
+            << R"(,"args":{"name":)" << to_json_string(thread_name) << "}}";
+        separator = ",\n";
+    }
+
+    for (const auto& event : events)
+    {
+        const auto& name = event.name.empty() ? cat("task ", event.task_id) : event.name;
+
+        out << separator << R"({"name":)" << to_json_string(name)
+            << R"(,"cat":"task","ph":"X","ts":)"
+            << to_microseconds(event.start_time - creation_time_)
+            << R"(,"dur":)" << to_microseconds(event.end_time - event.start_time)
+            << R"(,"pid":1,"tid":)" << event.thread_id
+            << R"(,"args":{"id":)" << event.task_id;
+
+        if (event.enqueue_time != SteadyTimePoint{})
+        {
+            out << R"(,"queued_us":)"
+                << to_microseconds(event.start_time - event.enqueue_time);
+        }
+
+        out << "}}";
+    }
+
+    out << "\n]}\n";
+}
+
+bool ThreadPool::wait_idle(const Duration timeout) const
+{
+    if (current_pool_ == this)
+    {
+        throw std::logic_error(
+            "Cannot wait for a thread pool to become idle from one of its threads");
+    }
+
+    return wait_idle_until(detail::get_deadline(timeout));
+}
+
+bool ThreadPool::wait_idle_until(const SteadyTimePoint deadline) const
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    const auto is_idle = [this]()
+        {
+            const auto worker_locks = lock_workers();
+            return is_idle_i();
+        };
+
+    // Announce the waiting thread before checking the state of the pool. Together with
+    // notify_idle_waiters_i(), this ensures that no wakeup is lost.
+    ++num_idle_waiters_;
+
+    bool result = true;
+
+    if (deadline == SteadyTimePoint::max())
+        idle_cv_.wait(lock, is_idle);
+    else
+        result = idle_cv_.wait_until(lock, deadline, is_idle);
+
+    --num_idle_waiters_;
+
+    return result;
+}
+
+bool ThreadPool::retire_worker_i(const SteadyTimePoint idle_since)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - idle_since < keep_alive_)
+        return false;
+
+    // Do not leave work behind that this thread was possibly woken up for
+    if (select_ready_slot_i() != no_slot || num_local_tasks_ != 0)
+        return false;
+    if (not scheduled_tasks_.empty()
+        && task_slots_[scheduled_tasks_.front()].task_.start_time_ <= now)
+    {
+        return false;
+    }
+
+    auto num_threads = num_threads_.load();
+    do
+    {
+        if (num_threads <= min_num_threads_)
+            return false;
+    }
+    while (not num_threads_.compare_exchange_weak(num_threads, num_threads - 1));
+
+    // The notification that woke up this thread may have been meant for a new delayed
+    // task. Pass it on so that another thread recalculates its wakeup time.
+    notify_workers(claim_wakeups_i(1));
+
+    return true;
+}
+
+void ThreadPool::spawn_worker()
+{
+    if (not spawn_requested_.exchange(false))
+        return;
+
+    auto num_threads = num_threads_.load();
+    do
+    {
+        if (num_threads >= max_num_threads_)
+            return;
+    }
+    while (not num_threads_.compare_exchange_weak(num_threads, num_threads + 1));
+
+    std::lock_guard<std::mutex> lock(threads_mutex_);
+
+    const auto it = std::find(is_thread_active_.begin(), is_thread_active_.end(), false);
+
+    // A terminating thread may not have released its slot yet
+    if (shutdown_requested_ || it == is_thread_active_.end())
+    {
+        --num_threads_;
+        return;
+    }
+
+    const auto idx = static_cast<ThreadId>(it - is_thread_active_.begin());
+
+    // The previous thread in this slot has already left its work loop
+    if (threads_[idx].joinable())
+        threads_[idx].join();
+
+    try
+    {
+        threads_[idx] = std::thread([this, idx]() { perform_work(idx); });
+        is_thread_active_[idx] = true;
+    }
+    catch (const std::system_error&)
+    {
+        // The pool keeps working with the threads it has
+        --num_threads_;
+    }
+}
+
+void ThreadPool::wake_sleeping_workers(const std::size_t num_tasks)
+{
+    if (num_sleeping_ == 0)
+    {
+        if (not thread_metrics_.empty())
+            num_wakeups_avoided_.fetch_add(num_tasks, std::memory_order_relaxed);
+        return;
+    }
+
+    // Acquiring the mutex makes sure that the sleeping thread has either not checked
+    // the number of local tasks yet or is already waiting on the condition variable.
+    std::size_t num_wakeups;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        num_wakeups = claim_wakeups_i(num_tasks);
+    }
+
+    notify_workers(num_wakeups);
+}
+
+std::size_t ThreadPool::claim_wakeups_i(const std::size_t num_tasks)
+{
+    const std::size_t num_unsignaled = num_sleeping_ - num_signaled_;
+    const auto num_wakeups = std::min(num_tasks, num_unsignaled);
+
+    num_signaled_ += num_wakeups;
+
+    if (not thread_metrics_.empty())
+    {
+        num_wakeups_.fetch_add(num_wakeups, std::memory_order_relaxed);
+        num_wakeups_avoided_.fetch_add(
+            num_tasks - num_wakeups, std::memory_order_relaxed);
+    }
+
+    return num_wakeups;
+}
+
+void ThreadPool::notify_workers(const std::size_t num_wakeups)
+{
+    for (std::size_t i = 0; i != num_wakeups; ++i)
+        cv_.notify_one();
+}
+
+void ThreadPool::notify_idle_waiters_i()
+{
+    if (num_idle_waiters_ != 0 && num_pending_ == 0)
+        idle_cv_.notify_all();
+}
+
+bool ThreadPool::spin_for_work(const std::size_t num_pending) const
+{
+    const auto deadline = std::chrono::steady_clock::now() + spin_time_;
+
+    // Any new task changes the number of pending tasks; false alarms (e.g. from canceled
+    // tasks) only cost one more pass through the work loop.
+    do
+    {
+        if (num_pending_ != num_pending || num_local_tasks_ != 0 || shutdown_requested_)
+            return true;
+
+        std::this_thread::yield();
+    }
+    while (std::chrono::steady_clock::now() < deadline);
+
+    return false;
+}
+
+thread_local ThreadPool::ThreadId
+ThreadPool::thread_id_{ std::numeric_limits<ThreadPool::ThreadId>::max() };
+
+thread_local const ThreadPool* ThreadPool::current_pool_{ nullptr };
 
 } // namespace gul17
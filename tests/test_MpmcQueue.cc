@@ -0,0 +1,169 @@
+/**
+ * \file  test_MpmcQueue.cc
+ * \date  Created on October 17, 2026
+ * \brief Test suite for the MpmcQueue class.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "gul17/MpmcQueue.h"
+
+using gul17::MpmcQueue;
+
+TEST_CASE("MpmcQueue: try_push(), try_pop()", "[MpmcQueue]")
+{
+    MpmcQueue<std::string, 4> queue;
+    REQUIRE(queue.capacity() == 4u);
+    REQUIRE(queue.empty());
+
+    std::string str;
+    REQUIRE(queue.try_pop(str) == false);
+
+    for (const auto* s : { "a", "b", "c", "d" })
+        REQUIRE(queue.try_push(s));
+
+    const std::string e = "e";
+    REQUIRE(queue.size() == 4u);
+    REQUIRE(queue.try_push(e) == false);
+
+    REQUIRE(queue.try_pop(str));
+    REQUIRE(str == "a");
+    REQUIRE(queue.try_push(e));
+
+    for (const auto* expected : { "b", "c", "d", "e" })
+    {
+        REQUIRE(queue.try_pop(str));
+        REQUIRE(str == expected);
+    }
+
+    REQUIRE(queue.try_pop(str) == false);
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("MpmcQueue: Runtime capacity", "[MpmcQueue]")
+{
+    REQUIRE_THROWS_AS(MpmcQueue<int>(0), std::invalid_argument);
+    REQUIRE_THROWS_AS(MpmcQueue<int>(1), std::invalid_argument);
+    REQUIRE_THROWS_AS(MpmcQueue<int>(6), std::invalid_argument);
+
+    MpmcQueue<int> queue(8);
+    REQUIRE(queue.capacity() == 8u);
+
+    for (int round = 0; round != 3; ++round)
+    {
+        for (int i = 0; i != 8; ++i)
+            REQUIRE(queue.try_push(i));
+        REQUIRE(queue.try_push(8) == false);
+
+        for (int i = 0; i != 8; ++i)
+            REQUIRE(queue.pop() == i);
+        REQUIRE(queue.empty());
+    }
+}
+
+TEST_CASE("MpmcQueue: Blocking push() and pop()", "[MpmcQueue]")
+{
+    MpmcQueue<int, 2> queue;
+    queue.push(1);
+    queue.push(2);
+
+    std::thread producer([&queue]() { queue.push(3); }); // Blocks until there is space
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    REQUIRE(queue.pop() == 1);
+    producer.join();
+    REQUIRE(queue.pop() == 2);
+    REQUIRE(queue.pop() == 3);
+
+    std::thread consumer([&queue]() { REQUIRE(queue.pop() == 4); }); // Blocks
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    queue.push(4);
+    consumer.join();
+    REQUIRE(queue.empty());
+}
+
+TEST_CASE("MpmcQueue: Multiple producers and consumers", "[MpmcQueue]")
+{
+    constexpr int num_producers = 4;
+    constexpr int num_consumers = 4;
+    constexpr int num_per_producer = 20'000;
+
+    auto queue = std::make_unique<MpmcQueue<int, 64>>();
+    std::vector<std::vector<int>> received(num_consumers);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p != num_producers; ++p)
+    {
+        threads.emplace_back(
+            [&queue, p]()
+            {
+                for (int i = 0; i != num_per_producer; ++i)
+                {
+                    const int value = p * num_per_producer + i;
+                    if (i % 2 == 0)
+                        queue->push(value);
+                    else
+                        while (not queue->try_push(value)) {}
+                }
+            });
+    }
+    for (int c = 0; c != num_consumers; ++c)
+    {
+        threads.emplace_back(
+            [&queue, &received, c]()
+            {
+                auto& values = received[static_cast<std::size_t>(c)];
+                for (int i = 0; i != num_producers * num_per_producer / num_consumers; ++i)
+                    values.push_back(queue->pop());
+            });
+    }
+
+    for (auto& t : threads)
+        t.join();
+
+    REQUIRE(queue->empty());
+
+    // Every value is received exactly once, and values from the same producer arrive in
+    // order at each consumer
+    std::vector<int> count(num_producers * num_per_producer, 0);
+    for (const auto& values : received)
+    {
+        std::vector<int> last(num_producers, -1);
+        for (const int value : values)
+        {
+            ++count[static_cast<std::size_t>(value)];
+            const auto p = static_cast<std::size_t>(value / num_per_producer);
+            REQUIRE(value > last[p]);
+            last[p] = value;
+        }
+    }
+    REQUIRE(std::all_of(count.begin(), count.end(), [](int n) { return n == 1; }));
+}
+
+// vi:ts=4:sw=4:sts=4:et
@@ -0,0 +1,161 @@
+/**
+ * \file  test_RollingStatistics.cc
+ * \date  Created on October 17, 2026
+ * \brief Test suite for the RollingStatistics class.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include "gul17/RollingStatistics.h"
+
+using gul17::RollingStatistics;
+using Catch::Matchers::WithinRel;
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("RollingStatistics: Empty and single-value windows", "[RollingStatistics]")
+{
+    RollingStatistics<double, 4> stats;
+    REQUIRE(stats.empty());
+    REQUIRE(stats.capacity() == 4u);
+    REQUIRE(std::isnan(stats.mean()));
+    REQUIRE(std::isnan(stats.rms()));
+    REQUIRE(std::isnan(stats.standard_deviation().sigma()));
+    REQUIRE(std::isnan(stats.standard_deviation().mean()));
+    REQUIRE(std::isnan(stats.minimum()));
+    REQUIRE(std::isnan(stats.maximum()));
+    REQUIRE(stats.sum() == 0.0);
+
+    stats.push_back(3.0);
+    REQUIRE(stats.size() == 1u);
+    REQUIRE(stats.mean() == 3.0);
+    REQUIRE(stats.rms() == 3.0);
+    REQUIRE(std::isnan(stats.standard_deviation().sigma()));
+    REQUIRE(stats.standard_deviation().mean() == 3.0);
+    REQUIRE(stats.minimum() == 3.0);
+    REQUIRE(stats.maximum() == 3.0);
+
+    RollingStatistics<int, 2> int_stats;
+    REQUIRE(int_stats.minimum() == std::numeric_limits<int>::max());
+    REQUIRE(int_stats.maximum() == std::numeric_limits<int>::lowest());
+}
+
+TEST_CASE("RollingStatistics: Sliding window", "[RollingStatistics]")
+{
+    RollingStatistics<int, 3> stats;
+
+    for (int value : { 5, 1, 3, 4, 2 })
+        stats.push_back(value);
+
+    // Window contains 3, 4, 2
+    REQUIRE(stats.filled());
+    REQUIRE(stats.sum() == 9.0);
+    REQUIRE(stats.mean() == 3.0);
+    REQUIRE_THAT(stats.rms(), WithinRel(std::sqrt(29.0 / 3.0), 1e-12));
+    REQUIRE_THAT(stats.standard_deviation().sigma(), WithinRel(1.0, 1e-12));
+    REQUIRE(stats.minimum() == 2);
+    REQUIRE(stats.maximum() == 4);
+
+    const auto mm = stats.min_max();
+    REQUIRE(mm.min == 2);
+    REQUIRE(mm.max == 4);
+
+    stats.clear();
+    REQUIRE(stats.empty());
+    REQUIRE(std::isnan(stats.mean()));
+    REQUIRE(stats.minimum() == std::numeric_limits<int>::max());
+}
+
+TEST_CASE("RollingStatistics: Agreement with statistics.h", "[RollingStatistics]")
+{
+    RollingStatistics<double> stats(50);
+    REQUIRE(stats.capacity() == 50u);
+
+    std::mt19937 rng{ 4711 };
+    std::normal_distribution<double> dist{ 1000.0, 3.0 };
+
+    for (int i = 0; i != 2000; ++i)
+    {
+        stats.push_back(dist(rng));
+
+        const auto& buf = stats.buffer();
+        REQUIRE_THAT(stats.mean(), WithinRel(gul17::mean(buf), 1e-12));
+        REQUIRE_THAT(stats.rms(), WithinRel(gul17::rms(buf), 1e-12));
+        REQUIRE(stats.minimum() == gul17::minimum(buf));
+        REQUIRE(stats.maximum() == gul17::maximum(buf));
+
+        if (buf.size() > 1)
+        {
+            REQUIRE_THAT(stats.standard_deviation().sigma(),
+                WithinRel(gul17::standard_deviation(buf).sigma(), 1e-8));
+        }
+    }
+
+    const auto sigma = stats.standard_deviation().sigma();
+    stats.recalculate();
+    REQUIRE_THAT(stats.standard_deviation().sigma(), WithinRel(sigma, 1e-8));
+    REQUIRE_THAT(stats.standard_deviation().sigma(),
+        WithinRel(gul17::standard_deviation(stats.buffer()).sigma(), 1e-12));
+}
+
+TEST_CASE("RollingStatistics: NaN values", "[RollingStatistics]")
+{
+    RollingStatistics<float, 3> stats;
+    const auto nan = std::numeric_limits<float>::quiet_NaN();
+
+    stats.push_back(1.0f);
+    stats.push_back(nan);
+    stats.push_back(3.0f);
+
+    REQUIRE(std::isnan(stats.mean()));
+    REQUIRE(std::isnan(stats.rms()));
+    REQUIRE(std::isnan(stats.sum()));
+    REQUIRE(std::isnan(stats.standard_deviation().sigma()));
+    REQUIRE(stats.minimum() == 1.0f);
+    REQUIRE(stats.maximum() == 3.0f);
+
+    stats.push_back(5.0f);
+    REQUIRE(std::isnan(stats.mean()));
+    REQUIRE(stats.minimum() == 3.0f);
+
+    stats.push_back(7.0f); // NaN drops out of the window
+    REQUIRE(stats.mean() == 5.0);
+    REQUIRE_THAT(stats.standard_deviation().sigma(), WithinAbs(2.0, 1e-12));
+    REQUIRE(stats.minimum() == 3.0f);
+    REQUIRE(stats.maximum() == 7.0f);
+
+    stats.push_back(nan);
+    stats.push_back(nan);
+    stats.push_back(nan);
+    REQUIRE(std::isnan(stats.minimum()));
+    REQUIRE(std::isnan(stats.maximum()));
+
+    stats.push_back(2.0f);
+    REQUIRE(stats.minimum() == 2.0f);
+    REQUIRE(stats.maximum() == 2.0f);
+}
+
+// vi:ts=4:sw=4:sts=4:et
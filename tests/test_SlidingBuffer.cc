@@ -24,8 +24,10 @@
  */
 
 #include <iostream>
+#include <iterator>
 #include <random>
 #include <sstream>
+#include <tuple>
 
 #include <catch2/catch_test_macros.hpp>
 #include <catch2/matchers/catch_matchers_string.hpp>
@@ -41,6 +43,7 @@ using Catch::Matchers::Matches;
 using Catch::Matchers::StartsWith;
 using gul17::SlidingBuffer;
 using gul17::SlidingBufferExposed;
+using gul17::SlidingBufferPow2;
 
 // A dummy struct for tests with nontrivial elements.
 struct MyStruct {
@@ -800,6 +803,142 @@ TEST_CASE("SlidingBuffer: pop_front()", "[SlidingBuffer]")
     REQUIRE(buf.filled() == false);
 }
 
+TEST_CASE("SlidingBuffer: push_back() with a range of elements", "[SlidingBuffer]")
+{
+    SlidingBuffer<int, 5> buf;
+    const std::vector<int> data{ 1, 2, 3, 4, 5, 6, 7, 8 };
+
+    SECTION("Range fits into the empty buffer")
+    {
+        buf.push_back(data.begin(), data.begin() + 3);
+        REQUIRE(buf.size() == 3u);
+        REQUIRE(buf.filled() == false);
+        REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 1, 2, 3 });
+
+        buf.push_back(data.begin(), data.begin() + 2);
+        REQUIRE(buf.filled());
+        REQUIRE(std::vector<int>(buf.begin(), buf.end())
+            == std::vector<int>{ 1, 2, 3, 1, 2 });
+    }
+
+    SECTION("Range wraps around the end of the container")
+    {
+        buf.push_back(0);
+        buf.push_back(0);
+        buf.push_back(0);
+        buf.push_back(data.begin(), data.begin() + 4);
+        REQUIRE(buf.filled());
+        REQUIRE(std::vector<int>(buf.begin(), buf.end())
+            == std::vector<int>{ 0, 1, 2, 3, 4 });
+
+        buf.push_back(gul17::span<const int>(data.data(), 2));
+        REQUIRE(std::vector<int>(buf.begin(), buf.end())
+            == std::vector<int>{ 2, 3, 4, 1, 2 });
+        REQUIRE(buf.front() == 2);
+        REQUIRE(buf.back() == 2);
+    }
+
+    SECTION("Range is larger than the capacity")
+    {
+        buf.push_back(42);
+        buf.push_back(data);
+        REQUIRE(buf.filled());
+        REQUIRE(std::vector<int>(buf.begin(), buf.end())
+            == std::vector<int>{ 4, 5, 6, 7, 8 });
+    }
+
+    SECTION("Input iterators")
+    {
+        std::istringstream ss{ "1 2 3 4 5 6" };
+        buf.push_back(std::istream_iterator<int>{ ss }, std::istream_iterator<int>{});
+        REQUIRE(std::vector<int>(buf.begin(), buf.end())
+            == std::vector<int>{ 2, 3, 4, 5, 6 });
+    }
+
+    SECTION("Same result as element-wise push_back()")
+    {
+        SlidingBuffer<int> ref(7);
+        SlidingBuffer<int> bulk(7);
+
+        std::mt19937 rng{ 1 };
+        std::uniform_int_distribution<std::size_t> dist{ 0, 9 };
+
+        for (int i = 0; i != 100; ++i)
+        {
+            const auto num = dist(rng);
+            for (std::size_t j = 0; j != num; ++j)
+                ref.push_back(data[j % data.size()] + i);
+
+            std::vector<int> block;
+            for (std::size_t j = 0; j != num; ++j)
+                block.push_back(data[j % data.size()] + i);
+            bulk.push_back(block.begin(), block.end());
+
+            REQUIRE(bulk.size() == ref.size());
+            REQUIRE(bulk.filled() == ref.filled());
+            REQUIRE(std::equal(bulk.begin(), bulk.end(), ref.begin(), ref.end()));
+        }
+    }
+}
+
+TEST_CASE("SlidingBuffer: as_segments()", "[SlidingBuffer]")
+{
+    SlidingBuffer<int, 4> buf;
+
+    auto [a, b] = buf.as_segments();
+    REQUIRE(a.empty());
+    REQUIRE(b.empty());
+
+    buf.push_back(1);
+    buf.push_back(2);
+    std::tie(a, b) = buf.as_segments();
+    REQUIRE(std::vector<int>(a.begin(), a.end()) == std::vector<int>{ 1, 2 });
+    REQUIRE(b.empty());
+
+    buf.push_back(3);
+    buf.push_back(4);
+    std::tie(a, b) = buf.as_segments();
+    REQUIRE(std::vector<int>(a.begin(), a.end()) == std::vector<int>{ 1, 2, 3, 4 });
+    REQUIRE(b.empty());
+
+    buf.push_back(5);
+    buf.push_back(6);
+    std::tie(a, b) = buf.as_segments();
+    REQUIRE(std::vector<int>(a.begin(), a.end()) == std::vector<int>{ 3, 4 });
+    REQUIRE(std::vector<int>(b.begin(), b.end()) == std::vector<int>{ 5, 6 });
+
+    a[0] = 30;
+    REQUIRE(buf.front() == 30);
+
+    buf.push_front(0);
+    const auto& cbuf = buf;
+    auto [c, d] = cbuf.as_segments();
+    REQUIRE(std::vector<int>(c.begin(), c.end()) == std::vector<int>{ 0, 30, 4 });
+    REQUIRE(std::vector<int>(d.begin(), d.end()) == std::vector<int>{ 5 });
+}
+
+TEST_CASE("SlidingBuffer: pop_front(count), pop_back(count)", "[SlidingBuffer]")
+{
+    SlidingBuffer<int, 4> buf;
+    buf.push_back(std::vector<int>{ 1, 2, 3, 4, 5, 6 });
+
+    buf.pop_front(0);
+    REQUIRE(buf.filled());
+
+    buf.pop_front(3);
+    REQUIRE(buf.size() == 1u);
+    REQUIRE(buf.front() == 6);
+
+    buf.push_back(std::vector<int>{ 7, 8, 9 });
+    REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 6, 7, 8, 9 });
+
+    buf.pop_back(2);
+    REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 6, 7 });
+
+    buf.pop_back(2);
+    REQUIRE(buf.empty());
+}
+
 TEST_CASE("SlidingBuffer copying and moving", "[SlidingBuffer]")
 {
     auto buffer = SlidingBuffer<TestElement<double, unsigned int>>(6);
@@ -1537,4 +1676,148 @@ TEST_CASE("SlidingBufferIterator: std::distance()", "[SlidingBufferIterator]")
 }
 
 
+TEST_CASE("SlidingBufferPow2: push_back(), push_front(), pop_back(), pop_front()",
+    "[SlidingBufferPow2]")
+{
+    SlidingBufferPow2<int, 4> buf;
+    REQUIRE(buf.empty());
+    REQUIRE(buf.filled() == false);
+    REQUIRE(buf.capacity() == 4u);
+
+    for (int i = 0; i != 6; ++i)
+        buf.push_back(i);
+
+    REQUIRE(buf.size() == 4u);
+    REQUIRE(buf.filled());
+    REQUIRE(buf.front() == 2);
+    REQUIRE(buf.back() == 5);
+    REQUIRE(buf[1] == 3);
+    REQUIRE(buf.at(2) == 4);
+    REQUIRE_THROWS_AS(buf.at(4), std::out_of_range);
+
+    buf.push_front(1);
+    REQUIRE(buf.size() == 4u);
+    REQUIRE(buf.front() == 1);
+    REQUIRE(buf.back() == 4);
+
+    buf.pop_back();
+    REQUIRE(buf.size() == 3u);
+    REQUIRE(buf.filled() == false);
+    REQUIRE(buf.back() == 3);
+
+    buf.pop_front();
+    REQUIRE(buf.size() == 2u);
+    REQUIRE(buf.front() == 2);
+
+    REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 2, 3 });
+    REQUIRE(std::vector<int>(buf.rbegin(), buf.rend()) == std::vector<int>{ 3, 2 });
+
+    std::stringstream ss;
+    ss << buf;
+    REQUIRE(ss.str() == "2  3  \n");
+
+    buf.clear();
+    REQUIRE(buf.empty());
+    REQUIRE(buf.size() == 0u);
+}
+
+TEST_CASE("SlidingBufferPow2: Behaves like SlidingBuffer", "[SlidingBufferPow2]")
+{
+    SlidingBuffer<int, 8> ref;
+    SlidingBufferPow2<int, 8> buf;
+
+    std::mt19937 rng{ 42 };
+    std::uniform_int_distribution<int> dist{ 0, 3 };
+
+    for (int i = 0; i != 1000; ++i)
+    {
+        switch (dist(rng))
+        {
+        case 0: ref.push_back(i); buf.push_back(i); break;
+        case 1: ref.push_front(i); buf.push_front(i); break;
+        case 2: if (not ref.empty()) { ref.pop_back(); buf.pop_back(); } break;
+        default: if (not ref.empty()) { ref.pop_front(); buf.pop_front(); } break;
+        }
+
+        REQUIRE(buf.size() == ref.size());
+        REQUIRE(buf.filled() == ref.filled());
+        REQUIRE(std::equal(buf.begin(), buf.end(), ref.begin(), ref.end()));
+    }
+}
+
+TEST_CASE("SlidingBufferPow2: Bulk operations", "[SlidingBufferPow2]")
+{
+    SlidingBufferPow2<int, 4> buf;
+    buf.push_back(0);
+
+    buf.push_back(std::vector<int>{ 1, 2, 3, 4, 5 });
+    REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 2, 3, 4, 5 });
+
+    buf.pop_front(1);
+    buf.push_back(std::vector<int>{ 6, 7 });
+    REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 4, 5, 6, 7 });
+
+    auto [a, b] = buf.as_segments();
+    REQUIRE(a.size() + b.size() == 4u);
+    std::vector<int> joined(a.begin(), a.end());
+    joined.insert(joined.end(), b.begin(), b.end());
+    REQUIRE(joined == std::vector<int>{ 4, 5, 6, 7 });
+
+    buf.pop_back(3);
+    REQUIRE(buf.size() == 1u);
+    REQUIRE(buf.back() == 4);
+
+    std::tie(a, b) = buf.as_segments();
+    REQUIRE(a.size() == 1u);
+    REQUIRE(a[0] == 4);
+    REQUIRE(b.empty());
+}
+
+TEST_CASE("SlidingBufferPow2: Vector-based buffer", "[SlidingBufferPow2]")
+{
+    REQUIRE_THROWS_AS(SlidingBufferPow2<int>(3), std::invalid_argument);
+
+    SlidingBufferPow2<int> buf(4);
+    REQUIRE(buf.capacity() == 4u);
+    REQUIRE_THROWS_AS(buf.resize(6), std::invalid_argument);
+    REQUIRE(buf.capacity() == 4u);
+
+    for (int i = 0; i != 6; ++i)
+        buf.push_back(i);
+
+    SECTION("Growing keeps all elements")
+    {
+        buf.resize(8);
+        REQUIRE(buf.capacity() == 8u);
+        REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 2, 3, 4, 5 });
+
+        buf.push_back(6);
+        REQUIRE(buf.size() == 5u);
+        REQUIRE(buf.back() == 6);
+    }
+
+    SECTION("Shrinking with keep_front_elements")
+    {
+        buf.resize(2);
+        REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 2, 3 });
+        REQUIRE(buf.filled());
+    }
+
+    SECTION("Shrinking with keep_back_elements")
+    {
+        buf.resize(2, gul17::ShrinkBehavior::keep_back_elements);
+        REQUIRE(std::vector<int>(buf.begin(), buf.end()) == std::vector<int>{ 4, 5 });
+        REQUIRE(buf.filled());
+    }
+
+    SECTION("Resizing to zero")
+    {
+        buf.resize(0);
+        REQUIRE(buf.capacity() == 0u);
+        REQUIRE(buf.empty());
+        REQUIRE(buf.filled() == false);
+    }
+}
+
+
 // vi:ts=4:sw=4:sts=4:et
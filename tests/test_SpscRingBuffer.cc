@@ -0,0 +1,143 @@
+/**
+ * \file  test_SpscRingBuffer.cc
+ * \date  Created on October 17, 2026
+ * \brief Test suite for the SpscRingBuffer class.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "gul17/SpscRingBuffer.h"
+
+using gul17::SpscRingBuffer;
+
+TEST_CASE("SpscRingBuffer: try_push(), try_pop()", "[SpscRingBuffer]")
+{
+    SpscRingBuffer<std::string, 4> buf;
+    REQUIRE(buf.capacity() == 4u);
+    REQUIRE(buf.empty());
+
+    std::string str;
+    REQUIRE(buf.try_pop(str) == false);
+
+    REQUIRE(buf.try_push("a"));
+    const std::string b = "b";
+    REQUIRE(buf.try_push(b));
+    REQUIRE(buf.try_push("c"));
+    REQUIRE(buf.try_push("d"));
+    REQUIRE(buf.size() == 4u);
+    REQUIRE(buf.try_push("e") == false);
+
+    REQUIRE(buf.try_pop(str));
+    REQUIRE(str == "a");
+    REQUIRE(buf.try_push("e"));
+
+    for (const auto* expected : { "b", "c", "d", "e" })
+    {
+        REQUIRE(buf.try_pop(str));
+        REQUIRE(str == expected);
+    }
+
+    REQUIRE(buf.try_pop(str) == false);
+    REQUIRE(buf.empty());
+}
+
+TEST_CASE("SpscRingBuffer: write(), read()", "[SpscRingBuffer]")
+{
+    SpscRingBuffer<int, 8> buf;
+    const std::vector<int> data{ 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 };
+    std::array<int, 10> out{ };
+
+    REQUIRE(buf.write(gul17::span<const int>(data.data(), 5)) == 5u);
+    REQUIRE(buf.read(gul17::span<int>(out.data(), 3)) == 3u);
+    REQUIRE(out[0] == 1);
+    REQUIRE(out[2] == 3);
+
+    // Only 6 of the 10 elements fit, wrapping around the end of the storage
+    REQUIRE(buf.write(data) == 6u);
+    REQUIRE(buf.size() == 8u);
+    REQUIRE(buf.write(data) == 0u);
+
+    REQUIRE(buf.read(out) == 8u);
+    REQUIRE(out == std::array<int, 10>{ 4, 5, 1, 2, 3, 4, 5, 6, 0, 0 });
+    REQUIRE(buf.read(out) == 0u);
+    REQUIRE(buf.empty());
+}
+
+TEST_CASE("SpscRingBuffer: Producer and consumer threads", "[SpscRingBuffer]")
+{
+    constexpr int num_elements = 100'000;
+
+    auto buf = std::make_unique<SpscRingBuffer<int, 64>>();
+
+    std::thread producer(
+        [&buf]()
+        {
+            std::array<int, 16> block{ };
+            int next = 0;
+
+            while (next < num_elements)
+            {
+                if (next % 3 == 0)
+                {
+                    if (buf->try_push(next))
+                        ++next;
+                    continue;
+                }
+
+                const auto num = std::min<int>(block.size(), num_elements - next);
+                for (int i = 0; i != num; ++i)
+                    block[i] = next + i;
+
+                next += static_cast<int>(buf->write(
+                    gul17::span<const int>(block.data(), static_cast<std::size_t>(num))));
+            }
+        });
+
+    std::vector<int> received;
+    received.reserve(num_elements);
+
+    std::array<int, 10> block{ };
+    while (received.size() < num_elements)
+    {
+        int value;
+        if (buf->try_pop(value))
+            received.push_back(value);
+
+        const auto num = buf->read(block);
+        received.insert(received.end(), block.begin(), block.begin() + num);
+    }
+
+    producer.join();
+
+    REQUIRE(received.size() == num_elements);
+    for (int i = 0; i != num_elements; ++i)
+        REQUIRE(received[i] == i);
+}
+
+// vi:ts=4:sw=4:sts=4:et
@@ -26,14 +26,28 @@
 #include <algorithm>
 #include <array>
 #include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
 
+#include "gul17/cat.h"
 #include "gul17/ThreadPool.h"
 #include "gul17/time_util.h"
 #include "gul17/Trigger.h"
 
+#if defined(__linux__)
+#   include <pthread.h>
+#endif
+
 using namespace gul17;
 using namespace std::literals;
 
@@ -112,6 +126,88 @@ TEST_CASE("TaskHandle: is_complete()", "[ThreadPool][TaskHandle]")
     pool.reset();
 }
 
+TEST_CASE("TaskHandle: request_stop()", "[ThreadPool][TaskHandle]")
+{
+    auto pool = make_thread_pool(2);
+
+    SECTION("A running task stops when it sees the request")
+    {
+        std::atomic<bool> started{ false };
+        auto handle = pool->add_task(
+            [&started](StopToken token)
+            {
+                started = true;
+                int num_iterations = 0;
+                while (not token.stop_requested())
+                {
+                    ++num_iterations;
+                    gul17::sleep(100us);
+                }
+                return num_iterations;
+            });
+
+        while (not started)
+            gul17::sleep(1ms);
+
+        REQUIRE(handle.request_stop() == true);
+        REQUIRE(handle.request_stop() == false); // Already requested
+        REQUIRE(handle.get_result() >= 0);
+    }
+
+    SECTION("Tasks may take a ThreadPool reference and a StopToken")
+    {
+        auto handle = pool->add_task(
+            [](ThreadPool& p, StopToken token)
+            {
+                while (not token.stop_requested())
+                    gul17::sleep(100us);
+                return p.count_threads();
+            }, "stoppable");
+
+        REQUIRE(handle.request_stop() == true);
+        REQUIRE(handle.get_result() == 2);
+    }
+
+    SECTION("A pending task sees the request when it starts")
+    {
+        auto handle = pool->add_task(
+            [](StopToken token) { return token.stop_requested(); }, 1h);
+
+        REQUIRE(handle.request_stop() == true);
+        REQUIRE(handle.get_state() == TaskState::pending);
+        pool->cancel_pending_tasks();
+
+        auto handle2 = pool->add_task(
+            [](StopToken token) { return token.stop_requested(); }, 20ms);
+        handle2.request_stop();
+        REQUIRE(handle2.get_result() == true);
+    }
+
+    SECTION("Tasks without StopToken cannot be stopped")
+    {
+        auto handle = pool->add_task([]() { return 1; });
+        REQUIRE(handle.request_stop() == false);
+        REQUIRE(handle.get_result() == 1);
+
+        REQUIRE(ThreadPool::TaskHandle<int>{}.request_stop() == false);
+        REQUIRE(StopToken{}.stop_requested() == false);
+    }
+
+    SECTION("try_add_task() and add_task_wait() support stop tokens")
+    {
+        auto handle = pool->try_add_task([](StopToken token)
+            { while (not token.stop_requested()) gul17::sleep(100us); });
+        REQUIRE(handle.has_value());
+        REQUIRE(handle->request_stop());
+        handle->get_result();
+
+        auto handle2 = pool->add_task_wait([](const StopToken& token)
+            { while (not token.stop_requested()) gul17::sleep(100us); });
+        REQUIRE(handle2.request_stop());
+        handle2.get_result();
+    }
+}
+
 TEST_CASE("TaskHandle: get_state()", "[ThreadPool][TaskHandle]")
 {
     auto pool = make_thread_pool(1);
@@ -154,6 +250,16 @@ TEST_CASE("TaskHandle: get_state()", "[ThreadPool][TaskHandle]")
     pool.reset();
 }
 
+TEST_CASE("PeriodicTaskHandle: Default constructor", "[ThreadPool]")
+{
+    ThreadPool::PeriodicTaskHandle handle;
+
+    REQUIRE(handle.count_runs() == 0);
+    REQUIRE(handle.count_overruns() == 0);
+    REQUIRE_THROWS_AS(handle.cancel(), std::logic_error);
+    REQUIRE_THROWS_AS(handle.get_state(), std::logic_error);
+}
+
 
 //
 // ThreadPool class
@@ -179,6 +285,32 @@ TEST_CASE("ThreadPool: Constructor", "[ThreadPool]")
     {
         REQUIRE_THROWS_AS(make_thread_pool(0), std::invalid_argument);
     }
+
+    SECTION("Create a thread pool from options")
+    {
+        ThreadPool::Options options;
+        options.num_threads = 3;
+        options.capacity = 17;
+        options.work_stealing = true;
+
+        auto pool = make_thread_pool(options);
+        REQUIRE(pool->count_threads() == 3);
+        REQUIRE(pool->capacity() == 17);
+    }
+
+    SECTION("Maximum number of threads must not be less than the number of threads")
+    {
+        ThreadPool::Options options;
+        options.num_threads = 3;
+        options.max_num_threads = 2;
+        REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+
+        options.max_num_threads = ThreadPool::max_threads + 1;
+        REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+
+        options.max_num_threads = 3;
+        REQUIRE_NOTHROW(make_thread_pool(options));
+    }
 }
 
 TEST_CASE("ThreadPool: add_task() for functions without ThreadPool&", "[ThreadPool]")
@@ -338,6 +470,86 @@ TEST_CASE("ThreadPool: add_task(f(ThreadPool&, ...))", "[ThreadPool]")
     pool.reset();
 }
 
+TEST_CASE("ThreadPool: add_periodic_task()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(2);
+
+    SECTION("Fixed rate")
+    {
+        std::atomic<int> count{ 0 };
+
+        auto task = pool->add_periodic_task([&count]() { ++count; }, 2ms, "periodic");
+
+        while (task.count_runs() < 5)
+            gul17::sleep(1ms);
+
+        REQUIRE(count >= 5);
+        REQUIRE(task.get_state() != TaskState::canceled);
+
+        REQUIRE(task.cancel() == true);
+        REQUIRE(task.cancel() == false);
+
+        while (task.get_state() == TaskState::running)
+            gul17::sleep(1ms);
+
+        REQUIRE(task.get_state() == TaskState::canceled);
+        REQUIRE(pool->count_pending() == 0);
+
+        const auto runs = task.count_runs();
+        gul17::sleep(10ms);
+        REQUIRE(task.count_runs() == runs);
+        REQUIRE(count == static_cast<int>(runs));
+    }
+
+    SECTION("Overruns are counted for fixed rate, but not for fixed delay")
+    {
+        auto task1 = pool->add_periodic_task([]() { gul17::sleep(7ms); }, 2ms, 0ms,
+            PeriodicTaskMode::fixed_rate, "fixed rate");
+        auto task2 = pool->add_periodic_task([](ThreadPool&) { gul17::sleep(7ms); }, 2ms,
+            0ms, PeriodicTaskMode::fixed_delay, "fixed delay");
+
+        while (task1.count_runs() < 3 || task2.count_runs() < 3)
+            gul17::sleep(1ms);
+
+        task1.cancel();
+        task2.cancel();
+
+        REQUIRE(task1.count_overruns() >= 2);
+        REQUIRE(task2.count_overruns() == 0);
+    }
+
+    SECTION("Pending periodic tasks show up with their name")
+    {
+        auto task = pool->add_periodic_task([]() {}, 1h, 1h, PeriodicTaskMode::fixed_rate,
+            "hourly");
+
+        REQUIRE(task.get_state() == TaskState::pending);
+        REQUIRE(pool->get_pending_task_names() == std::vector<std::string>{ "hourly" });
+        REQUIRE(task.cancel() == true);
+        REQUIRE(pool->get_pending_task_names().empty());
+    }
+
+    SECTION("Exceptions do not stop a periodic task")
+    {
+        auto task = pool->add_periodic_task(
+            []() { throw std::runtime_error("Boom"); }, 1ms);
+
+        while (task.count_runs() < 3)
+            gul17::sleep(1ms);
+
+        task.cancel();
+    }
+
+    SECTION("Illegal period")
+    {
+        REQUIRE_THROWS_AS(pool->add_periodic_task([]() {}, 0s), std::invalid_argument);
+        REQUIRE_THROWS_AS(pool->add_periodic_task([]() {}, -1s), std::invalid_argument);
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
 TEST_CASE("ThreadPool: cancel_pending_tasks()", "[ThreadPool]")
 {
     auto pool = make_thread_pool(1);
@@ -433,7 +645,7 @@ TEST_CASE("ThreadPool: get_pending_task_names()", "[ThreadPool]")
 
 TEST_CASE("ThreadPool: get_running_task_names()", "[ThreadPool]")
 {
-    auto pool = make_thread_pool(1);
+    auto pool = make_thread_pool(ThreadPool::Options{ 1, 100, GENERATE(false, true) });
 
     REQUIRE(pool->get_running_task_names().empty());
 
@@ -451,6 +663,42 @@ TEST_CASE("ThreadPool: get_running_task_names()", "[ThreadPool]")
 
     stop = true;
 
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+    REQUIRE(pool->get_running_task_names().empty());
+
+    // Detached tasks are reported without a name
+    std::atomic<bool> stop_detached{ false };
+    pool->add_detached_task(
+        [&stop_detached]() { while (!stop_detached) gul17::sleep(10us); });
+    while (pool->count_pending() != 0)
+        gul17::sleep(1ms);
+
+    running_names = pool->get_running_task_names();
+    stop_detached = true;
+    REQUIRE(running_names.size() == 1);
+    REQUIRE(running_names[0].empty());
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    // A named task that is being destroyed is not listed with an empty name
+    struct RecordsRunningNames
+    {
+        ThreadPool& pool_;
+        std::promise<std::vector<std::string>>& names_;
+
+        ~RecordsRunningNames() { names_.set_value(pool_.get_running_task_names()); }
+    };
+
+    std::promise<std::vector<std::string>> names_on_destruction;
+    auto future = names_on_destruction.get_future();
+    auto recorder = std::shared_ptr<RecordsRunningNames>(
+        new RecordsRunningNames{ *pool, names_on_destruction });
+    pool->add_task([recorder = std::move(recorder)]() { return recorder != nullptr; },
+        "named");
+    REQUIRE(future.get().empty());
+
     // Make sure the pool is removed before any of the atomic variables go out of scope
     pool.reset();
 }
@@ -486,6 +734,57 @@ TEST_CASE("ThreadPool: get_thread_id()", "[ThreadPool]")
         REQUIRE(indices[1] == 0);
 }
 
+TEST_CASE("ThreadPool: get_thread_cpu()", "[ThreadPool]")
+{
+    SECTION("Threads are not pinned by default")
+    {
+        auto pool = make_thread_pool(2);
+        REQUIRE(pool->add_task(
+            [](ThreadPool& p) { return p.get_thread_cpu(p.get_thread_id()); })
+            .get_result() == -1);
+        REQUIRE_THROWS_AS(pool->get_thread_cpu(2), std::out_of_range);
+    }
+
+    SECTION("Illegal options are rejected")
+    {
+        ThreadPool::Options options;
+        options.pin_threads = true;
+        options.cpus = { 0, -1 };
+        REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+
+        options.pin_threads = false;
+        options.scheduling_policy = ThreadSchedulingPolicy::other;
+        options.scheduling_priority = 1000;
+        REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+    }
+
+#if defined(__linux__)
+    SECTION("Threads are pinned round-robin to the available CPUs")
+    {
+        ThreadPool::Options options;
+        options.num_threads = 2;
+        options.pin_threads = true;
+        options.thread_name = "pinned";
+        auto pool = make_thread_pool(options);
+
+        auto handle = pool->add_task(
+            [](ThreadPool& p)
+            {
+                char name[16] = {};
+                pthread_getname_np(pthread_self(), name, sizeof(name));
+                return std::make_pair(p.get_thread_cpu(p.get_thread_id()),
+                    cat(name, ' ', p.get_thread_id()));
+            });
+
+        const auto [cpu, name] = handle.get_result();
+        REQUIRE(cpu >= 0);
+
+        const auto thread_id = name.substr(name.find(' ') + 1);
+        REQUIRE(name == cat("pinned", thread_id, ' ', thread_id));
+    }
+#endif
+}
+
 TEST_CASE("ThreadPool: is_full()", "[ThreadPool]")
 {
     auto pool = make_thread_pool(1);
@@ -520,6 +819,175 @@ TEST_CASE("ThreadPool: is_idle()", "[ThreadPool]")
     REQUIRE(pool->is_idle());
 }
 
+TEST_CASE("detail::get_deadline()", "[ThreadPool]")
+{
+    using SteadyTimePoint = std::chrono::steady_clock::time_point;
+    using Milliseconds32 = std::chrono::duration<std::int32_t, std::milli>;
+    using Picoseconds = std::chrono::duration<long long, std::pico>;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    SECTION("Very long timeouts saturate instead of overflowing")
+    {
+        REQUIRE(detail::get_deadline(std::chrono::hours::max()) == SteadyTimePoint::max());
+        REQUIRE(detail::get_deadline(ThreadPool::Duration::max())
+            == SteadyTimePoint::max());
+        REQUIRE(detail::get_deadline(std::chrono::microseconds::max())
+            == SteadyTimePoint::max());
+        REQUIRE(detail::get_deadline(std::chrono::nanoseconds::max())
+            == SteadyTimePoint::max());
+        REQUIRE(detail::get_deadline(std::chrono::duration<double>::max())
+            == SteadyTimePoint::max());
+    }
+
+    SECTION("Long timeouts that fit are converted exactly")
+    {
+        const auto deadline = detail::get_deadline(Milliseconds32::max());
+        REQUIRE(deadline - t0 >= Milliseconds32::max());
+        REQUIRE(deadline - t0 < Milliseconds32::max() + 1h);
+
+        REQUIRE(detail::get_deadline(Picoseconds::max()) - t0 >= 100 * 24h);
+        REQUIRE(detail::get_deadline(Picoseconds::max()) != SteadyTimePoint::max());
+    }
+
+    SECTION("Short and negative timeouts")
+    {
+        const auto deadline = detail::get_deadline(10ms);
+        REQUIRE(deadline >= t0 + 10ms);
+        REQUIRE(deadline < t0 + 1h);
+
+        const auto deadline_negative = detail::get_deadline(-1s);
+        const auto deadline_min = detail::get_deadline(std::chrono::hours::min());
+        const auto t1 = std::chrono::steady_clock::now();
+        REQUIRE(deadline_negative <= t1);
+        REQUIRE(deadline_min <= t1);
+    }
+}
+
+TEST_CASE("ThreadPool: wait_idle()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(
+        ThreadPool::Options{ 2, 100, GENERATE(false, true) });
+
+    REQUIRE(pool->wait_idle(0s));
+
+    std::atomic<int> count{ 0 };
+    for (int i = 0; i != 10; ++i)
+    {
+        pool->add_task(
+            [&count](ThreadPool& p)
+            {
+                gul17::sleep(1ms);
+                p.add_task([&count]() { gul17::sleep(1ms); ++count; });
+                ++count;
+            });
+    }
+
+    REQUIRE(pool->wait_idle());
+    REQUIRE(count == 20);
+    REQUIRE(pool->is_idle());
+
+    SECTION("Timeout")
+    {
+        pool->add_task([]() { gul17::sleep(50ms); });
+        REQUIRE_FALSE(pool->wait_idle(1ms));
+        REQUIRE(pool->wait_idle(10s));
+    }
+
+    SECTION("Cancellation makes the pool idle")
+    {
+        pool->add_task([]() {}, 1h);
+        REQUIRE_FALSE(pool->wait_idle(1ms));
+        pool->cancel_pending_tasks();
+        REQUIRE(pool->wait_idle(10s));
+    }
+
+    SECTION("Cannot wait from a worker thread")
+    {
+        auto handle = pool->add_task([](ThreadPool& p) { p.wait_idle(); });
+        REQUIRE_THROWS_AS(handle.get_result(), std::logic_error);
+    }
+}
+
+TEST_CASE("ThreadPool: shutdown()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(
+        ThreadPool::Options{ 2, 100, GENERATE(false, true) });
+
+    std::atomic<int> count{ 0 };
+
+    SECTION("Drain executes all pending tasks")
+    {
+        std::vector<ThreadPool::TaskHandle<void>> handles;
+        for (int i = 0; i != 20; ++i)
+            handles.push_back(pool->add_task([&count]() { gul17::sleep(1ms); ++count; }));
+
+        REQUIRE(pool->shutdown(ShutdownMode::drain));
+        REQUIRE(count == 20);
+        for (auto& handle : handles)
+            REQUIRE(handle.is_complete());
+    }
+
+    SECTION("Discard cancels pending tasks")
+    {
+        std::atomic<bool> started{ false };
+        auto running = pool->add_task(
+            [&]() { started = true; gul17::sleep(20ms); ++count; });
+        while (not started)
+            gul17::sleep(1ms);
+
+        auto pending = pool->add_task([&count]() { ++count; }, 1h);
+
+        REQUIRE(pool->shutdown(ShutdownMode::discard));
+        REQUIRE(count == 1);
+        REQUIRE(running.is_complete());
+        REQUIRE_THROWS_AS(pending.get_result(), std::future_error);
+    }
+
+    SECTION("Timeout")
+    {
+        std::atomic<bool> stop{ false };
+        pool->add_task([&stop]() { while (not stop) gul17::sleep(1ms); });
+        pool->add_task([&count]() { ++count; }, 1h);
+
+        REQUIRE_FALSE(pool->shutdown(ShutdownMode::drain, 10ms));
+        REQUIRE(pool->is_shutdown_requested());
+        REQUIRE(pool->count_pending() == 0);
+        stop = true;
+        REQUIRE(pool->wait_idle(10s));
+        REQUIRE(count == 0);
+    }
+
+    SECTION("No tasks are accepted after shutdown")
+    {
+        REQUIRE(pool->shutdown(ShutdownMode::discard, 1s));
+        REQUIRE(pool->is_shutdown_requested());
+        REQUIRE_THROWS_AS(pool->add_task([]() {}), std::runtime_error);
+        REQUIRE_THROWS_AS(pool->add_detached_task([]() {}), std::runtime_error);
+        REQUIRE_THROWS_AS(pool->add_task_wait([]() {}), std::runtime_error);
+        REQUIRE_FALSE(pool->try_add_task([]() {}).has_value());
+    }
+
+    SECTION("A blocked producer is released")
+    {
+        auto small_pool = make_thread_pool(1, 1);
+        small_pool->add_task([]() {}, 1h);
+
+        auto producer = std::async(std::launch::async,
+            [&small_pool]() { small_pool->add_task_wait([]() {}); });
+
+        gul17::sleep(10ms);
+        REQUIRE(small_pool->shutdown(ShutdownMode::discard, 1s));
+        REQUIRE_THROWS_AS(producer.get(), std::runtime_error);
+    }
+
+    SECTION("Cannot shut down from a worker thread")
+    {
+        auto handle = pool->add_task([](ThreadPool& p) { p.shutdown(); });
+        REQUIRE_THROWS_AS(handle.get_result(), std::logic_error);
+    }
+}
+
 TEST_CASE("ThreadPool: Run 100 functions on a single thread, check order", "[ThreadPool]")
 {
     auto pool = make_thread_pool(1);
@@ -596,6 +1064,82 @@ TEST_CASE("ThreadPool: Run 100 functions on 4 threads", "[ThreadPool]")
     pool.reset();
 }
 
+TEST_CASE("ThreadPool: Dynamic scaling", "[ThreadPool]")
+{
+    ThreadPool::Options options;
+    options.num_threads = 1;
+    options.max_num_threads = 3;
+    options.work_stealing = GENERATE(false, true);
+    options.spawn_latency = 1ms;
+    options.keep_alive = 20ms;
+    auto pool = make_thread_pool(options);
+
+    REQUIRE(pool->count_threads() == 1);
+
+    std::atomic<bool> go{ false };
+    std::atomic<int> num_started{ 0 };
+    const auto blocker = [&go, &num_started]()
+        {
+            ++num_started;
+            while (!go)
+                gul17::sleep(100us);
+        };
+
+    SECTION("Threads are added when tasks wait too long and retire when idle")
+    {
+        // Occupy the only thread, then let a task wait in the queue
+        pool->add_task(blocker);
+        while (num_started != 1)
+            gul17::sleep(1ms);
+
+        auto first = pool->add_task([]() { return 1; });
+        gul17::sleep(5ms);
+
+        // This task finds the first one waiting for too long and launches a new thread
+        auto second = pool->add_task([]() { return 2; });
+
+        const auto num_results = first.get_result() + second.get_result();
+        const auto num_threads = pool->count_threads();
+        go = true;
+
+        REQUIRE(num_results == 3);
+        REQUIRE(num_threads >= 2);
+
+        auto t0 = tic();
+        while (pool->count_threads() != 1 && toc(t0) < 10.0)
+            gul17::sleep(1ms);
+        REQUIRE(pool->count_threads() == 1);
+
+        // The pool keeps working with its minimum number of threads
+        REQUIRE(pool->add_task([]() { return 3; }).get_result() == 3);
+    }
+
+    SECTION("The number of threads does not exceed the maximum")
+    {
+        for (int i = 0; i != 10; ++i)
+        {
+            pool->add_task(blocker);
+            gul17::sleep(3ms);
+            CHECK(pool->count_threads() <= 3);
+        }
+
+        while (num_started != 3)
+            gul17::sleep(1ms);
+        const auto num_threads = pool->count_threads();
+        const auto num_pending = pool->count_pending();
+        go = true;
+
+        REQUIRE(num_threads == 3);
+        REQUIRE(num_pending == 7);
+    }
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
 TEST_CASE("ThreadPool: Capacity limit", "[ThreadPool]")
 {
     std::size_t max_jobs{ 10 };
@@ -642,46 +1186,1062 @@ TEST_CASE("ThreadPool: Capacity limit", "[ThreadPool]")
     pool.reset();
 }
 
-TEST_CASE("ThreadPool: Tasks scheduling their own continuation", "[ThreadPool]")
+TEST_CASE("ThreadPool: try_add_task(), add_task_wait(), add_task_wait_for()",
+    "[ThreadPool]")
 {
-    auto pool = make_thread_pool(2);
+    const bool work_stealing = GENERATE(false, true);
 
-    std::mutex mutex;
-    std::string str;
+    ThreadPool::Options options;
+    options.num_threads = 1;
+    options.capacity = 2;
+    options.work_stealing = work_stealing;
+    auto pool = make_thread_pool(options);
 
-    pool->add_task(
-        [&mutex, &str](ThreadPool& p)
-        {
+    std::atomic<bool> go{ false };
+    const auto blocker = [&go]() { while (!go) gul17::sleep(100us); };
+
+    // Occupy the worker thread and fill the queue
+    pool->add_task(blocker);
+    while (pool->count_pending() != 0)
+        gul17::sleep(1ms);
+    pool->add_task(blocker);
+    pool->add_task(blocker);
+    REQUIRE(pool->is_full());
+
+    SECTION("try_add_task() returns an empty optional if the queue is full")
+    {
+        auto handle = pool->try_add_task([]() { return 42; });
+        REQUIRE(not handle.has_value());
+        REQUIRE(pool->count_pending() == 2);
+
+        go = true;
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        handle = pool->try_add_task([]() { return 42; }, "answer");
+        REQUIRE(handle.has_value());
+        REQUIRE(handle->get_result() == 42);
+    }
+
+    SECTION("add_task_wait_for() gives up after the timeout")
+    {
+        const auto t0 = tic();
+        auto handle = pool->add_task_wait_for([]() {}, 20ms);
+        REQUIRE(not handle.has_value());
+        REQUIRE(toc<std::chrono::milliseconds>(t0) >= 19);
+        go = true;
+    }
+
+    SECTION("add_task_wait_for() succeeds when space becomes available")
+    {
+        auto releaser = std::async(std::launch::async,
+            [&go]() { gul17::sleep(10ms); go = true; });
+
+        auto handle = pool->add_task_wait_for([]() { return 1; }, 1h);
+        REQUIRE(handle.has_value());
+        REQUIRE(handle->get_result() == 1);
+    }
+
+    SECTION("add_task_wait_for() with Duration::max() waits until space is available")
+    {
+        auto producer = std::async(std::launch::async,
+            [&pool]()
             {
-                std::lock_guard<std::mutex> lock(mutex);
-                str += '1';
-            }
+                return pool->add_task_wait_for(
+                    []() { return 3; }, ThreadPool::Duration::max());
+            });
 
-            p.add_task(
-                [&mutex, &str]()
-                {
-                    {
-                        std::lock_guard<std::mutex> lock(mutex);
-                        str += '2';
-                    }
-                });
+        // The producer must neither give up nor succeed while the queue is full
+        REQUIRE(producer.wait_for(20ms) == std::future_status::timeout);
 
-            p.add_task(
-                [&mutex, &str]()
-                {
-                    {
-                        std::lock_guard<std::mutex> lock(mutex);
-                        str += '3';
-                    }
-                }, 3ms);
-        });
+        go = true;
+        auto handle = producer.get();
+        REQUIRE(handle.has_value());
+        REQUIRE(handle->get_result() == 3);
+    }
 
-    while (not pool->is_idle())
-        gul17::sleep(1ms);
+    SECTION("add_task_wait() blocks until space is available")
+    {
+        auto releaser = std::async(std::launch::async,
+            [&go]() { gul17::sleep(10ms); go = true; });
+
+        auto handle = pool->add_task_wait([]() { return 2; });
+        REQUIRE(handle.get_result() == 2);
+    }
 
+    SECTION("Waiting producers are woken up when tasks are canceled")
     {
-        std::lock_guard<std::mutex> lock(mutex);
-        REQUIRE(str == "123");
+        std::atomic<int> num_added{ 0 };
+        auto producer = std::async(std::launch::async,
+            [&pool, &num_added]()
+            {
+                for (int i = 0; i != 2; ++i)
+                {
+                    pool->add_task_wait([]() {});
+                    ++num_added;
+                }
+            });
+
+        gul17::sleep(10ms);
+        REQUIRE(num_added == 0);
+        pool->cancel_pending_tasks();
+        producer.get();
+        REQUIRE(num_added == 2);
+        go = true;
+    }
+
+    SECTION("Many producers are throttled without losing tasks")
+    {
+        go = true;
+        std::atomic<int> counter{ 0 };
+        std::vector<std::future<void>> producers;
+
+        for (int p = 0; p != 4; ++p)
+        {
+            producers.push_back(std::async(std::launch::async,
+                [&pool, &counter]()
+                {
+                    for (int i = 0; i != 100; ++i)
+                        pool->add_task_wait([&counter]() { ++counter; });
+                }));
+        }
+
+        for (auto& producer : producers)
+            producer.get();
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        REQUIRE(counter == 400);
+    }
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: add_task() with steady clock time points", "[ThreadPool]")
+{
+    using std::chrono::steady_clock;
+
+    auto pool = make_thread_pool(2);
+
+    const auto start_time = steady_clock::now() + 20ms;
+
+    auto task1 = pool->add_task([]() { return steady_clock::now(); }, start_time);
+    auto task2 = pool->add_task(
+        [](ThreadPool&) { return steady_clock::now(); }, start_time, "task 2");
+    auto task3 = pool->add_task(
+        []() { return steady_clock::now(); }, ThreadPool::SteadyTimePoint{});
+
+    REQUIRE(task1.get_state() == TaskState::pending);
+    REQUIRE(task2.get_state() == TaskState::pending);
+
+    REQUIRE(task3.get_result() < start_time);
+
+    const auto t1 = task1.get_result();
+    const auto t2 = task2.get_result();
+
+    REQUIRE(t1 >= start_time);
+    REQUIRE(t2 >= start_time);
+
+    // Generous bound for the start latency, even for slow test machines
+    REQUIRE(t1 - start_time < 1s);
+    REQUIRE(t2 - start_time < 1s);
+}
+
+TEST_CASE("ThreadPool: add_tasks()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(4, 100);
+
+    SECTION("Generator")
+    {
+        auto handles = pool->add_tasks(100,
+            [](std::size_t i) { return [i]() { return i * i; }; }, "square");
+
+        REQUIRE(handles.size() == 100);
+        for (std::size_t i = 0; i != handles.size(); ++i)
+            REQUIRE(handles[i].get_result() == i * i);
+    }
+
+    SECTION("Range of function objects")
+    {
+        std::atomic<int> count{ 0 };
+        std::vector<std::function<int(ThreadPool&)>> fcts;
+        for (int i = 0; i != 10; ++i)
+            fcts.push_back([i, &count](ThreadPool&) { ++count; return i; });
+
+        auto handles = pool->add_tasks(fcts.begin(), fcts.end());
+
+        REQUIRE(handles.size() == 10);
+        for (int i = 0; i != 10; ++i)
+            REQUIRE(handles[i].get_result() == i);
+        REQUIRE(count == 10);
+        REQUIRE(fcts.size() == 10);
+    }
+
+    SECTION("Empty batch")
+    {
+        std::vector<std::function<void()>> fcts;
+        REQUIRE(pool->add_tasks(fcts.begin(), fcts.end()).empty());
+        REQUIRE(pool->count_pending() == 0);
+    }
+
+    SECTION("Tasks are pending and can be canceled")
+    {
+        Trigger go;
+        pool->add_tasks(4, [&go](std::size_t) { return [&go]() { go.wait(); }; });
+
+        while (pool->count_pending() != 0)
+            gul17::sleep(1ms);
+
+        auto handles = pool->add_tasks(3, [](std::size_t) { return []() {}; }, "batch");
+        REQUIRE(pool->count_pending() == 3);
+        REQUIRE(pool->get_pending_task_names()
+            == std::vector<std::string>{ "batch", "batch", "batch" });
+        REQUIRE(handles[1].cancel() == true);
+        REQUIRE(handles[1].get_state() == TaskState::canceled);
+        REQUIRE(pool->count_pending() == 2);
+
+        go = true;
+        handles[0].get_result();
+        handles[2].get_result();
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+    }
+
+    SECTION("A batch that exceeds the capacity is rejected as a whole")
+    {
+        Trigger go;
+        pool->add_tasks(4, [&go](std::size_t) { return [&go]() { go.wait(); }; });
+
+        while (pool->count_pending() != 0)
+            gul17::sleep(1ms);
+
+        pool->add_tasks(60, [](std::size_t) { return []() {}; });
+        REQUIRE_THROWS_AS(pool->add_tasks(41, [](std::size_t) { return []() {}; }),
+            std::runtime_error);
+        REQUIRE(pool->count_pending() == 60);
+        REQUIRE_NOTHROW(pool->add_tasks(40, [](std::size_t) { return []() {}; }));
+        REQUIRE(pool->is_full());
+
+        go = true;
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+    }
+
+    SECTION("Batch from a worker of a work-stealing pool")
+    {
+        pool = make_thread_pool(ThreadPool::Options{ 4, 1000, true });
+
+        auto outer = pool->add_task(
+            [](ThreadPool& p)
+            {
+                return p.add_tasks(500, [](std::size_t i) { return [i]() { return i; }; });
+            });
+
+        auto handles = outer.get_result();
+        REQUIRE(handles.size() == 500);
+        for (std::size_t i = 0; i != handles.size(); ++i)
+            REQUIRE(handles[i].get_result() == i);
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("TaskHandle: then()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(ThreadPool::Options{ 2, 100, GENERATE(false, true) });
+
+    SECTION("Chain of continuations")
+    {
+        auto handle = pool->add_task([]() { return 2; })
+            .then([](int x) { return x * 21; })
+            .then([](int x) { return std::to_string(x); }, "to_string");
+
+        REQUIRE(handle.get_result() == "42");
+    }
+
+    SECTION("Continuation of a task without result")
+    {
+        std::atomic<int> count{ 0 };
+
+        auto handle = pool->add_task([&count]() { ++count; })
+            .then([&count]() { return count * 10; });
+
+        REQUIRE(handle.get_result() == 10);
+    }
+
+    SECTION("Continuation stays pending until the predecessor has finished")
+    {
+        Trigger go;
+        auto first = pool->add_task([&go]() { go.wait(); return 1; }, "first");
+
+        while (first.get_state() != TaskState::running)
+            gul17::sleep(1ms);
+
+        auto second = std::move(first).then([](int x) { return x + 1; }, "second");
+        REQUIRE(second.get_state() == TaskState::pending);
+        REQUIRE(pool->get_pending_task_names() == std::vector<std::string>{ "second" });
+
+        go = true;
+        REQUIRE(second.get_result() == 2);
+    }
+
+    SECTION("Continuation of a task that has already finished")
+    {
+        auto first = pool->add_task([]() { return 1; });
+        while (not first.is_complete())
+            gul17::sleep(1ms);
+
+        REQUIRE(std::move(first).then([](int x) { return x + 1; }).get_result() == 2);
+    }
+
+    SECTION("Exceptions are forwarded along the chain")
+    {
+        std::atomic<bool> called{ false };
+
+        auto handle = pool->add_task([]() -> int { throw std::runtime_error("Test"); })
+            .then([&called](int x) { called = true; return x; });
+
+        REQUIRE_THROWS_AS(handle.get_result(), std::runtime_error);
+        REQUIRE(called == false);
+    }
+
+    SECTION("Canceling the predecessor breaks the promise of the continuation")
+    {
+        auto handle = pool->add_task([]() { return 1; }, 1h)
+            .then([](int x) { return x; });
+
+        REQUIRE(pool->count_pending() == 2);
+        REQUIRE(pool->cancel_pending_tasks() == 2);
+        REQUIRE_THROWS_AS(handle.get_result(), std::future_error);
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: add_task_graph()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(ThreadPool::Options{ 4, 100, GENERATE(false, true) });
+
+    SECTION("Diamond-shaped graph")
+    {
+        std::mutex mutex;
+        std::string log;
+        const auto add_to_log = [&mutex, &log](char c)
+            {
+                return [&mutex, &log, c]()
+                    {
+                        gul17::sleep(1ms);
+                        std::lock_guard<std::mutex> lock(mutex);
+                        log += c;
+                    };
+            };
+
+        ThreadPool::TaskGraph graph;
+        const auto a = graph.add_node(add_to_log('a'), {}, "a");
+        const auto b = graph.add_node(add_to_log('b'), { a }, "b");
+        const auto c = graph.add_node(add_to_log('c'), { a }, "c");
+        const auto d = graph.add_node(add_to_log('d'), { b, c }, "d");
+        REQUIRE(graph.size() == 4);
+        REQUIRE(d == 3);
+
+        auto handles = pool->add_task_graph(std::move(graph));
+        REQUIRE(handles.size() == 4);
+        handles[d].get_result();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(log.size() == 4);
+        REQUIRE(log.front() == 'a');
+        REQUIRE(log.back() == 'd');
+    }
+
+    SECTION("Waiting nodes are pending and can be canceled")
+    {
+        Trigger go;
+        std::atomic<int> count{ 0 };
+
+        ThreadPool::TaskGraph graph;
+        const auto a = graph.add_node([&go]() { go.wait(); }, {}, "a");
+        const auto b = graph.add_node([&count]() { ++count; }, { a }, "b");
+        const auto c = graph.add_node([&count]() { ++count; }, { b }, "c");
+
+        auto handles = pool->add_task_graph(std::move(graph));
+
+        while (handles[a].get_state() != TaskState::running)
+            gul17::sleep(1ms);
+
+        REQUIRE(pool->get_pending_task_names() == std::vector<std::string>{ "b", "c" });
+        REQUIRE(handles[c].get_state() == TaskState::pending);
+
+        // Canceling b releases c
+        REQUIRE(handles[b].cancel());
+        handles[c].get_result();
+        REQUIRE(count == 1);
+        REQUIRE(handles[a].get_state() == TaskState::running);
+
+        go = true;
+        handles[a].get_result();
+    }
+
+    SECTION("Dependencies must refer to existing nodes")
+    {
+        ThreadPool::TaskGraph graph;
+        REQUIRE_THROWS_AS(graph.add_node([]() {}, { 0 }), std::invalid_argument);
+        graph.add_node([]() {});
+        REQUIRE_NOTHROW(graph.add_node([](ThreadPool&) { return 1; }, { 0 }));
+        REQUIRE_THROWS_AS(graph.add_node([]() {}, { 2 }), std::invalid_argument);
+    }
+
+    SECTION("A graph that exceeds the capacity is rejected as a whole")
+    {
+        ThreadPool::TaskGraph graph;
+        for (int i = 0; i != 101; ++i)
+            graph.add_node([]() {});
+
+        REQUIRE_THROWS_AS(pool->add_task_graph(std::move(graph)), std::runtime_error);
+        REQUIRE(pool->count_pending() == 0);
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: get_metrics()", "[ThreadPool]")
+{
+    SECTION("Metrics are disabled by default")
+    {
+        auto pool = make_thread_pool(1);
+        REQUIRE_THROWS_AS(pool->get_metrics(), std::logic_error);
+    }
+
+    SECTION("Counters and histograms")
+    {
+        ThreadPool::Options options;
+        options.num_threads = 2;
+        options.work_stealing = GENERATE(false, true);
+        options.collect_metrics = true;
+        auto pool = make_thread_pool(options);
+
+        for (int i = 0; i != 3; ++i)
+            pool->add_task([]() {}, 1h);
+        REQUIRE(pool->cancel_pending_tasks() == 3);
+
+        for (int i = 0; i != 5; ++i)
+            pool->add_task([]() { gul17::sleep(2ms); });
+        pool->add_task([]() { throw std::runtime_error("Test"); });
+        pool->add_detached_task([]() { throw std::runtime_error("Test"); });
+        auto periodic = pool->add_periodic_task(
+            []() { throw std::runtime_error("Test"); }, 1h);
+        while (periodic.count_runs() == 0)
+            gul17::sleep(1ms);
+        periodic.cancel();
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        const auto metrics = pool->get_metrics();
+        REQUIRE(metrics.num_completed == 5);
+        REQUIRE(metrics.num_failed == 3);
+        REQUIRE(metrics.num_canceled == 4);
+        REQUIRE(metrics.max_pending >= 3);
+        REQUIRE(metrics.queue_latency.get_count() == 8);
+        REQUIRE(metrics.execution_time.get_count() == 8);
+        REQUIRE(metrics.execution_time.get_quantile(1.0) >= 2ms);
+        REQUIRE(metrics.thread_busy_ratios.size() == 2);
+        for (const auto ratio : metrics.thread_busy_ratios)
+        {
+            REQUIRE(ratio >= 0.0);
+            REQUIRE(ratio <= 1.0);
+        }
+    }
+}
+
+TEST_CASE("ThreadPool: Wake-up coalescing", "[ThreadPool]")
+{
+    ThreadPool::Options options;
+    options.num_threads = 2;
+    options.work_stealing = GENERATE(false, true);
+    options.collect_metrics = true;
+
+    SECTION("Busy workers are not woken up")
+    {
+        auto pool = make_thread_pool(options);
+
+        // Keep both workers busy
+        std::atomic<bool> stop{ false };
+        std::atomic<int> num_started{ 0 };
+        for (int i = 0; i != 2; ++i)
+        {
+            pool->add_task([&]() { ++num_started; while (!stop) gul17::sleep(10us); });
+        }
+        while (num_started != 2)
+            gul17::sleep(1ms);
+
+        const auto before = pool->get_metrics();
+
+        std::atomic<int> count{ 0 };
+        for (int i = 0; i != 50; ++i)
+            pool->add_task([&count]() { ++count; });
+
+        const auto after = pool->get_metrics();
+        REQUIRE(after.num_wakeups == before.num_wakeups);
+        REQUIRE(after.num_wakeups_avoided == before.num_wakeups_avoided + 50);
+
+        stop = true;
+        while (count != 50)
+            gul17::sleep(1ms);
+
+        pool.reset();
+    }
+
+    SECTION("Spinning workers pick up tasks without being woken up")
+    {
+        options.spin_time = 10ms;
+        auto pool = make_thread_pool(options);
+
+        std::atomic<int> count{ 0 };
+        for (int i = 0; i != 20; ++i)
+        {
+            pool->add_task([&count]() { ++count; });
+            while (count != i + 1)
+                gul17::sleep(100us);
+        }
+
+        REQUIRE(pool->get_metrics().num_spin_hits > 0);
+
+        pool.reset();
+    }
+
+    SECTION("Negative spin time is rejected")
+    {
+        options.spin_time = -1ms;
+        REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+    }
+}
+
+TEST_CASE("ThreadPool: get_trace(), write_chrome_trace()", "[ThreadPool]")
+{
+    SECTION("Tracing is disabled by default")
+    {
+        auto pool = make_thread_pool(1);
+        REQUIRE_THROWS_AS(pool->get_trace(), std::logic_error);
+
+        std::ostringstream out;
+        REQUIRE_THROWS_AS(pool->write_chrome_trace(out), std::logic_error);
+    }
+
+    ThreadPool::Options options;
+    options.num_threads = 2;
+    options.work_stealing = GENERATE(false, true);
+    options.collect_metrics = GENERATE(false, true);
+    options.trace_capacity = 4;
+
+    SECTION("Events are recorded")
+    {
+        auto pool = make_thread_pool(options);
+        REQUIRE(pool->get_trace().empty());
+
+        auto handle = pool->add_task([]() { gul17::sleep(2ms); }, "My \"task\"");
+        pool->add_detached_task([]() {});
+        handle.get_result();
+        REQUIRE(pool->wait_idle(10s));
+
+        const auto events = pool->get_trace();
+        REQUIRE(events.size() == 2);
+
+        const auto it = std::find_if(events.begin(), events.end(),
+            [](const auto& e) { return not e.name.empty(); });
+        REQUIRE(it != events.end());
+        REQUIRE(it->name == "My \"task\"");
+        REQUIRE(it->thread_id < 2);
+        REQUIRE(it->enqueue_time <= it->start_time);
+        REQUIRE(it->end_time - it->start_time >= 2ms);
+
+        std::ostringstream out;
+        pool->write_chrome_trace(out);
+        const auto json = out.str();
+        REQUIRE(json.find(R"("traceEvents":[)") != std::string::npos);
+        REQUIRE(json.find(R"("name":"My \"task\"")") != std::string::npos);
+        REQUIRE(json.find(R"("name":"task )") != std::string::npos); // Detached task
+        REQUIRE(json.find(R"("ph":"M")") != std::string::npos);
+    }
+
+    SECTION("Only the most recent events are kept")
+    {
+        options.num_threads = 1;
+        auto pool = make_thread_pool(options);
+
+        for (int i = 0; i != 10; ++i)
+            pool->add_task([]() {}, cat("task", i));
+        REQUIRE(pool->wait_idle(10s));
+
+        const auto events = pool->get_trace();
+        REQUIRE(events.size() == 4);
+        REQUIRE(events[0].name == "task6");
+        REQUIRE(events[3].name == "task9");
+    }
+}
+
+TEST_CASE("ThreadPool::DurationHistogram", "[ThreadPool]")
+{
+    using Histogram = ThreadPool::DurationHistogram;
+
+    REQUIRE(Histogram::get_bucket(0us) == 0);
+    REQUIRE(Histogram::get_bucket(999ns) == 0);
+    REQUIRE(Histogram::get_bucket(1us) == 1);
+    REQUIRE(Histogram::get_bucket(3us) == 2);
+    REQUIRE(Histogram::get_bucket(4us) == 3);
+    REQUIRE(Histogram::get_bucket(24h) == Histogram::num_buckets - 1);
+
+    REQUIRE(Histogram::get_upper_bound(0) == 1us);
+    REQUIRE(Histogram::get_upper_bound(3) == 8us);
+    REQUIRE(Histogram::get_upper_bound(Histogram::num_buckets - 1)
+        == ThreadPool::Duration::max());
+
+    Histogram histogram;
+    REQUIRE(histogram.get_quantile(0.5) == ThreadPool::Duration::zero());
+    histogram.counts[1] = 90;
+    histogram.counts[10] = 10;
+    REQUIRE(histogram.get_count() == 100);
+    REQUIRE(histogram.get_quantile(0.5) == 2us);
+    REQUIRE(histogram.get_quantile(0.95) == 1024us);
+}
+
+TEST_CASE("ThreadPool: add_detached_task()", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(4, 200);
+    std::atomic<int> count{ 0 };
+
+    SECTION("Small and large callables with and without a ThreadPool argument")
+    {
+        std::array<char, 256> large_capture{};
+        large_capture[0] = 1;
+
+        for (int i = 0; i != 50; ++i)
+        {
+            pool->add_detached_task([&count]() { ++count; });
+            pool->add_detached_task([&count](ThreadPool&) { return ++count; });
+            pool->add_detached_task(
+                [&count, large_capture]() { count += large_capture[0]; });
+            pool->add_detached_task([]() { throw std::runtime_error("ignored"); });
+        }
+
+        while (count != 150)
+            gul17::sleep(1ms);
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        REQUIRE(count == 150);
+    }
+
+    SECTION("Detached tasks spawned from a worker of a work-stealing pool")
+    {
+        pool = make_thread_pool(ThreadPool::Options{ 4, 1000, true });
+
+        pool->add_detached_task(
+            [&count](ThreadPool& p)
+            {
+                for (int i = 0; i != 500; ++i)
+                    p.add_detached_task([&count]() { ++count; });
+            });
+
+        while (count != 500)
+            gul17::sleep(1ms);
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        REQUIRE(pool->count_pending() == 0);
+    }
+
+    SECTION("Delayed detached tasks are pending and have no name")
+    {
+        pool->add_detached_task([&count]() { ++count; }, 1h);
+        pool->add_detached_task([&count]() { ++count; },
+            std::chrono::steady_clock::now() + 1h);
+        pool->add_task([]() {}, 1h, "named");
+
+        REQUIRE(pool->count_pending() == 3);
+        auto names = pool->get_pending_task_names();
+        std::sort(names.begin(), names.end());
+        REQUIRE(names == std::vector<std::string>{ "", "", "named" });
+
+        REQUIRE(pool->cancel_pending_tasks() == 3);
+        REQUIRE(pool->count_pending() == 0);
+        REQUIRE(count == 0);
+    }
+
+    SECTION("Detached tasks respect the capacity limit")
+    {
+        std::atomic<bool> go{ false };
+
+        for (int i = 0; i != 200; ++i)
+            pool->add_detached_task([&go]() { while (!go) gul17::sleep(10us); }, 1h);
+
+        REQUIRE(pool->is_full());
+        REQUIRE_THROWS_AS(pool->add_detached_task([]() {}), std::runtime_error);
+        go = true;
+        pool->cancel_pending_tasks();
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Task priorities", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(ThreadPool::Options{ 1, 100, GENERATE(false, true) });
+
+    std::mutex mutex;
+    std::string log;
+    const auto add_to_log = [&mutex, &log](char c)
+        {
+            return [&mutex, &log, c]()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    log += c;
+                };
+        };
+
+    SECTION("Ready tasks are started in the order of their priorities")
+    {
+        Trigger go;
+        pool->add_task([&go]() { go.wait(); });
+        while (pool->count_pending() != 0)
+            gul17::sleep(1ms);
+
+        pool->add_task(add_to_log('l'), TaskPriority::low);
+        pool->add_task(add_to_log('n'));
+        pool->add_task(add_to_log('h'), TaskPriority::high, "high");
+        pool->add_task(add_to_log('L'), TaskPriority::low, "low");
+        pool->add_task(add_to_log('N'), TaskPriority::normal, 0s);
+        pool->add_task(add_to_log('H'), TaskPriority::high,
+            std::chrono::steady_clock::now());
+
+        go = true;
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(log == "hHnNlL");
+    }
+
+    SECTION("Delayed tasks only compete once their start time has come")
+    {
+        auto delayed = pool->add_task(add_to_log('h'), TaskPriority::high, 100ms);
+
+        Trigger go;
+        pool->add_task([&go]() { go.wait(); });
+        pool->add_task(add_to_log('l'), TaskPriority::low);
+
+        go = true;
+        delayed.get_result();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(log == "lh");
+    }
+
+    SECTION("High-priority tasks overtake tasks from a local queue")
+    {
+        pool->add_task(
+            [&add_to_log](ThreadPool& p)
+            {
+                for (int i = 0; i != 3; ++i)
+                    p.add_task(add_to_log('n'));
+                p.add_task(add_to_log('h'), TaskPriority::high);
+            });
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(log.size() == 4);
+        REQUIRE(log.front() == 'h');
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Priority aging", "[ThreadPool]")
+{
+    ThreadPool::Options options;
+    options.priority_aging = 20ms;
+    auto pool = make_thread_pool(options);
+
+    std::mutex mutex;
+    std::string log;
+    const auto add_to_log = [&mutex, &log](char c)
+        {
+            return [&mutex, &log, c]()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    log += c;
+                };
+        };
+
+    Trigger go;
+    pool->add_task([&go]() { go.wait(); });
+    while (pool->count_pending() != 0)
+        gul17::sleep(1ms);
+
+    // After more than three aging intervals, the low-priority task beats a fresh
+    // high-priority one
+    pool->add_task(add_to_log('l'), TaskPriority::low);
+    gul17::sleep(70ms);
+    pool->add_task(add_to_log('h'), TaskPriority::high);
+    pool->add_task(add_to_log('n'), TaskPriority::normal);
+
+    go = true;
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(log == "lhn");
+    }
+
+    options.priority_aging = -1s;
+    REQUIRE_THROWS_AS(make_thread_pool(options), std::invalid_argument);
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Delayed tasks start in the order of their start times",
+    "[ThreadPool]")
+{
+    auto pool = make_thread_pool(1, 1000);
+
+    std::mutex mutex;
+    std::vector<int> output;
+    std::vector<ThreadPool::TaskHandle<void>> handles;
+
+    const auto t0 = std::chrono::system_clock::now();
+
+    // Add tasks in reverse order of their start times
+    for (int i = 100; i != 0; --i)
+    {
+        handles.push_back(pool->add_task(
+            [i, &mutex, &output]()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                output.push_back(i);
+            },
+            t0 + 50ms + i * 100us));
+    }
+
+    // Cancel some tasks from the middle of the queue
+    for (std::size_t i = 10; i < handles.size(); i += 10)
+    {
+        REQUIRE(handles[i].get_state() == TaskState::pending);
+        REQUIRE(handles[i].cancel() == true);
+        REQUIRE(handles[i].get_state() == TaskState::canceled);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(pool->count_pending() + output.size() == 91);
+    }
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    REQUIRE(output.size() == 91);
+    REQUIRE(std::is_sorted(output.begin(), output.end()));
+    for (int i = 10; i < 100; i += 10)
+        REQUIRE(std::find(output.begin(), output.end(), 100 - i) == output.end());
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Tasks scheduling their own continuation", "[ThreadPool]")
+{
+    auto pool = make_thread_pool(2);
+
+    std::mutex mutex;
+    std::string str;
+
+    pool->add_task(
+        [&mutex, &str](ThreadPool& p)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                str += '1';
+            }
+
+            p.add_task(
+                [&mutex, &str]()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        str += '2';
+                    }
+                });
+
+            p.add_task(
+                [&mutex, &str]()
+                {
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        str += '3';
+                    }
+                }, 3ms);
+        });
+
+    while (not pool->is_idle())
+        gul17::sleep(1ms);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        REQUIRE(str == "123");
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Captured state may call back into the pool on destruction",
+    "[ThreadPool]")
+{
+    // Calls back into the pool when it is destroyed and counts completed destructions
+    struct CallsBackOnDestruction
+    {
+        ThreadPool& pool_;
+        std::atomic<int>& count_;
+
+        ~CallsBackOnDestruction()
+        {
+            pool_.cancel_pending_tasks();
+            pool_.try_add_task([]() {});
+            ++count_;
+        }
+    };
+
+    ThreadPool::Options options;
+    options.num_threads = 1;
+    options.work_stealing = GENERATE(false, true);
+    auto pool = make_thread_pool(options);
+
+    std::atomic<int> count{ 0 };
+
+    auto state = std::shared_ptr<CallsBackOnDestruction>(
+        new CallsBackOnDestruction{ *pool, count });
+    auto fct = [state = std::move(state)]() { return state != nullptr; };
+
+    SECTION("Executed task")
+    {
+        pool->add_task(std::move(fct));
+
+        while (count == 0)
+            gul17::sleep(1ms);
+        REQUIRE(count == 1);
+    }
+
+    SECTION("Task canceled via its handle")
+    {
+        auto handle = pool->add_task(std::move(fct), 1h);
+        REQUIRE(handle.cancel());
+        REQUIRE(count == 1);
+    }
+
+    SECTION("Task canceled with cancel_pending_tasks()")
+    {
+        pool->add_task(std::move(fct), 1h);
+        REQUIRE(pool->cancel_pending_tasks() == 1);
+        REQUIRE(count == 1);
+    }
+
+    SECTION("Task discarded by shutdown()")
+    {
+        pool->add_task(std::move(fct), 1h);
+        REQUIRE(pool->shutdown(ShutdownMode::discard));
+        REQUIRE(count == 1);
+    }
+
+    // Make sure the pool is removed before any captured variable goes out of scope
+    pool.reset();
+}
+
+TEST_CASE("ThreadPool: Work-stealing mode", "[ThreadPool]")
+{
+    ThreadPool::Options options;
+    options.num_threads = 4;
+    options.capacity = 1000;
+    options.work_stealing = true;
+
+    auto pool = make_thread_pool(options);
+
+    SECTION("Tasks spawned from within a worker are executed")
+    {
+        std::atomic<int> count{ 0 };
+
+        pool->add_task(
+            [&count](ThreadPool& p)
+            {
+                for (int i = 0; i != 500; ++i)
+                    p.add_task([&count]() { ++count; });
+            });
+
+        while (count != 500)
+            gul17::sleep(1ms);
+
+        while (not pool->is_idle())
+            gul17::sleep(1ms);
+
+        REQUIRE(pool->count_pending() == 0);
+    }
+
+    SECTION("Locally queued tasks can be inspected and canceled")
+    {
+        std::atomic<bool> stop{ false };
+        std::vector<ThreadPool::TaskHandle<void>> handles;
+        Trigger handles_ready;
+
+        // Occupy all threads so that locally queued tasks cannot be stolen
+        for (int i = 0; i != 3; ++i)
+            pool->add_task([&stop]() { while (!stop) gul17::sleep(10us); }, "busy");
+
+        pool->add_task(
+            [&](ThreadPool& p)
+            {
+                handles.push_back(p.add_task([]() {}, "a"));
+                handles.push_back(p.add_task([]() {}, "b"));
+                handles_ready = true;
+                while (!stop)
+                    gul17::sleep(10us);
+            }, "spawner");
+
+        handles_ready.wait();
+
+        REQUIRE(pool->count_pending() == 2);
+        REQUIRE(pool->get_pending_task_names() == std::vector<std::string>{ "a", "b" });
+        REQUIRE(pool->get_running_task_names().size() == 4);
+        REQUIRE(handles[0].get_state() == TaskState::pending);
+        REQUIRE(handles[1].get_state() == TaskState::pending);
+
+        REQUIRE(handles[0].cancel() == true);
+        REQUIRE(handles[0].get_state() == TaskState::canceled);
+        REQUIRE(pool->count_pending() == 1);
+
+        stop = true;
+
+        while (handles[1].get_state() != TaskState::complete)
+            gul17::sleep(1ms);
+        REQUIRE(handles[1].get_state() == TaskState::complete);
     }
 
     // Make sure the pool is removed before any captured variable goes out of scope
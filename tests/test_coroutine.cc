@@ -0,0 +1,221 @@
+/**
+ * \file  test_coroutine.cc
+ * \date  Created on October 17, 2026
+ * \brief Test suite for the ThreadPool awaitables in coroutine.h.
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "gul17/coroutine.h"
+#include "gul17/time_util.h"
+
+using namespace gul17;
+using namespace std::literals;
+
+#if defined(__cpp_lib_coroutine)
+
+namespace {
+
+/**
+ * A minimal eagerly started coroutine type that delivers its result through a
+ * std::future.
+ */
+template <typename T>
+struct Coroutine
+{
+    struct promise_type
+    {
+        std::promise<T> promise_;
+
+        Coroutine get_return_object() { return Coroutine{ promise_.get_future() }; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_value(T value) { promise_.set_value(std::move(value)); }
+        void unhandled_exception() { promise_.set_exception(std::current_exception()); }
+    };
+
+    std::future<T> future_;
+};
+
+Coroutine<std::thread::id> get_thread_id_after_schedule(ThreadPool& pool)
+{
+    co_await schedule(pool);
+    co_return std::this_thread::get_id();
+}
+
+Coroutine<int> add_results(ThreadPool& pool)
+{
+    auto a = pool.add_task([]() { gul17::sleep(10ms); return 3; });
+    auto b = pool.add_task([]() { return 4; });
+    co_return co_await std::move(a) + co_await std::move(b);
+}
+
+Coroutine<int> await_failing_task(ThreadPool& pool)
+{
+    auto handle = pool.add_task(
+        []() -> int { gul17::sleep(10ms); throw std::runtime_error("Test"); });
+    co_return co_await std::move(handle);
+}
+
+Coroutine<ThreadPool::Duration> measure_sleep(ThreadPool& pool, ThreadPool::Duration d)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    co_await sleep_for(pool, d);
+    co_return std::chrono::steady_clock::now() - t0;
+}
+
+/// An awaiter that stores the handle of the suspended coroutine before forwarding it.
+template <typename Awaiter>
+struct HandleRecordingAwaiter
+{
+    Awaiter awaiter_;
+    std::coroutine_handle<>& handle_;
+
+    bool await_ready() { return awaiter_.await_ready(); }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        handle_ = h;
+        awaiter_.await_suspend(h);
+    }
+    void await_resume() { awaiter_.await_resume(); }
+};
+
+template <typename Duration>
+Coroutine<int> sleep_forever(ThreadPool& pool, std::coroutine_handle<>& handle)
+{
+    co_await HandleRecordingAwaiter<detail::ScheduleAwaiter>{
+        sleep_for(pool, Duration::max()), handle };
+    co_return 1;
+}
+
+/// Check that sleeping for Duration::max() suspends the coroutine for good.
+template <typename Duration>
+void check_sleeps_forever(ThreadPool& pool)
+{
+    std::coroutine_handle<> handle;
+    auto coro = sleep_forever<Duration>(pool, handle);
+
+    REQUIRE(coro.future_.wait_for(20ms) == std::future_status::timeout);
+    REQUIRE(pool.count_pending() == 1);
+
+    pool.cancel_pending_tasks();
+    handle.destroy();
+}
+
+} // anonymous namespace
+
+TEST_CASE("ThreadPool coroutines: schedule()", "[coroutine]")
+{
+    auto pool = make_thread_pool(1);
+
+    auto coro = get_thread_id_after_schedule(*pool);
+    const auto id = coro.future_.get();
+
+    REQUIRE(id != std::this_thread::get_id());
+}
+
+TEST_CASE("ThreadPool coroutines: co_await TaskHandle", "[coroutine]")
+{
+    auto pool = make_thread_pool(2);
+
+    SECTION("Results are returned")
+    {
+        auto coro = add_results(*pool);
+        REQUIRE(coro.future_.get() == 7);
+    }
+
+    SECTION("Exceptions are rethrown")
+    {
+        auto coro = await_failing_task(*pool);
+        REQUIRE_THROWS_AS(coro.future_.get(), std::runtime_error);
+    }
+
+    SECTION("A task without result cannot be awaited")
+    {
+        auto handle = pool->add_task([]() { return 1; }, 1h);
+        handle.cancel();
+
+        auto coro = [](ThreadPool::TaskHandle<int> h) -> Coroutine<int>
+            {
+                co_return co_await std::move(h);
+            }(std::move(handle));
+
+        REQUIRE_THROWS_AS(coro.future_.get(), std::logic_error);
+    }
+
+    SECTION("A full queue does not cost the handle its result")
+    {
+        ThreadPool::Options options;
+        options.num_threads = 1;
+        options.capacity = 1;
+        auto small_pool = make_thread_pool(options);
+
+        std::atomic<bool> go{ false };
+        small_pool->add_task([&go]() { while (not go) gul17::sleep(100us); });
+        while (small_pool->count_pending() != 0)
+            gul17::sleep(1ms);
+
+        auto handle = small_pool->add_task([]() { return 42; });
+        REQUIRE(small_pool->is_full());
+
+        // The continuation that would resume the coroutine cannot be added
+        detail::TaskHandleAwaiter<int> awaiter{ std::move(handle) };
+        REQUIRE_THROWS_AS(awaiter.await_suspend(std::noop_coroutine()),
+            std::runtime_error);
+
+        go = true;
+        REQUIRE(awaiter.await_resume() == 42);
+
+        small_pool.reset();
+    }
+}
+
+TEST_CASE("ThreadPool coroutines: sleep_for()", "[coroutine]")
+{
+    auto pool = make_thread_pool(1);
+
+    SECTION("Coroutine is resumed after the given time")
+    {
+        auto coro = measure_sleep(*pool, 20ms);
+        REQUIRE(coro.future_.get() >= 20ms);
+        REQUIRE(pool->count_pending() == 0);
+    }
+
+    SECTION("ThreadPool::Duration::max() does not overflow into an immediate resumption")
+    {
+        check_sleeps_forever<ThreadPool::Duration>(*pool);
+    }
+
+    SECTION("hours::max() does not overflow into an immediate resumption")
+    {
+        check_sleeps_forever<std::chrono::hours>(*pool);
+    }
+}
+
+#endif // defined(__cpp_lib_coroutine)
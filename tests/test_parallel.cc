@@ -0,0 +1,214 @@
+/**
+ * \file  test_parallel.cc
+ * \date  Created on October 16, 2026
+ * \brief Test suite for parallel_for() and parallel_reduce().
+ *
+ * \copyright Copyright 2026 Deutsches Elektronen-Synchrotron (DESY), Hamburg
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ * software and associated documentation files (the "Software"), to deal in the Software
+ * without restriction, including without limitation the rights to use, copy, modify,
+ * merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies
+ * or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ * PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+ * CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR
+ * THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "gul17/parallel.h"
+#include "gul17/time_util.h"
+#include "gul17/Trigger.h"
+
+using namespace gul17;
+using namespace std::literals;
+
+TEST_CASE("parallel_for()", "[parallel]")
+{
+    auto pool = make_thread_pool(4);
+
+    SECTION("Every index is visited exactly once")
+    {
+        std::vector<std::atomic<int>> visits(10'000);
+
+        parallel_for(*pool, std::size_t{ 0 }, visits.size(),
+            [&visits](std::size_t i) { ++visits[i]; });
+
+        for (const auto& v : visits)
+            REQUIRE(v == 1);
+    }
+
+    SECTION("Negative indices and explicit grain size")
+    {
+        std::vector<std::atomic<int>> visits(200);
+
+        parallel_for(*pool, -100, 100, [&visits](int i) { ++visits[i + 100]; }, 7);
+
+        for (const auto& v : visits)
+            REQUIRE(v == 1);
+    }
+
+    SECTION("Empty ranges")
+    {
+        int count = 0;
+        parallel_for(*pool, 0, 0, [&count](int) { ++count; });
+        parallel_for(*pool, 5, 3, [&count](int) { ++count; });
+        REQUIRE(count == 0);
+    }
+
+    SECTION("Exceptions are propagated to the caller")
+    {
+        std::atomic<int> count{ 0 };
+
+        REQUIRE_THROWS_AS(
+            parallel_for(*pool, 0, 1000,
+                [&count](int i)
+                {
+                    ++count;
+                    if (i == 500)
+                        throw std::logic_error("Test");
+                }, 10),
+            std::logic_error);
+
+        REQUIRE(count >= 1);
+        REQUIRE(count <= 1000);
+    }
+
+    SECTION("Call from within a task does not deadlock")
+    {
+        // Occupy all workers with tasks that each run a parallel loop on the same pool
+        std::vector<ThreadPool::TaskHandle<long>> handles;
+        for (int t = 0; t != 4; ++t)
+        {
+            handles.push_back(pool->add_task(
+                [](ThreadPool& p)
+                {
+                    std::atomic<long> sum{ 0 };
+                    parallel_for(p, 0, 1000, [&sum](int i) { sum += i; });
+                    return sum.load();
+                }));
+        }
+
+        for (auto& handle : handles)
+            REQUIRE(handle.get_result() == 499'500);
+    }
+
+    SECTION("Full queue")
+    {
+        auto small_pool = make_thread_pool(2, 1);
+        Trigger go;
+        for (int i = 0; i != 2; ++i)
+        {
+            small_pool->add_task([&go]() { go.wait(); });
+            while (small_pool->count_pending() != 0)
+                gul17::sleep(1ms);
+        }
+        small_pool->add_task([&go]() { go.wait(); }, 1h);
+        REQUIRE(small_pool->is_full());
+
+        std::atomic<int> count{ 0 };
+        parallel_for(*small_pool, 0, 100, [&count](int) { ++count; });
+        REQUIRE(count == 100);
+
+        go = true;
+        small_pool.reset();
+    }
+}
+
+TEST_CASE("parallel_reduce()", "[parallel]")
+{
+    auto pool = make_thread_pool(3);
+
+    SECTION("Sum of squares")
+    {
+        const auto result = parallel_reduce(*pool, 0LL, 10'000LL, 0LL,
+            [](long long i) { return i * i; }, std::plus<>{});
+
+        REQUIRE(result == 333'283'335'000LL);
+    }
+
+    SECTION("Non-commutative reduction keeps the order")
+    {
+        const auto result = parallel_reduce(*pool, 0, 26, std::string{},
+            [](int i) { return std::string(1, static_cast<char>('a' + i)); },
+            std::plus<>{}, 3);
+
+        REQUIRE(result == "abcdefghijklmnopqrstuvwxyz");
+    }
+
+    SECTION("Boolean reduction over more chunks than workers")
+    {
+        // Each chunk writes its partial result from its own thread
+        for (int run = 0; run != 20; ++run)
+        {
+            REQUIRE(parallel_reduce(*pool, 0, 1000, true,
+                [](int i) { return i != 999; }, std::logical_and<>{}, 1) == false);
+            REQUIRE(parallel_reduce(*pool, 0, 1000, false,
+                [](int i) { return i == 0; }, std::logical_or<>{}, 1) == true);
+            REQUIRE(parallel_reduce(*pool, 0, 1000, true,
+                [](int) { return true; }, std::logical_and<>{}, 1) == true);
+        }
+    }
+
+    SECTION("Full range of a signed index type")
+    {
+        constexpr auto min = std::numeric_limits<std::int16_t>::min();
+        constexpr auto max = std::numeric_limits<std::int16_t>::max();
+
+        const auto result = parallel_reduce(*pool, min, max, 0LL,
+            [](std::int16_t i) -> long long { return i; }, std::plus<>{});
+
+        REQUIRE(result == -65535LL);
+    }
+
+    SECTION("Empty range returns the identity")
+    {
+        REQUIRE(parallel_reduce(*pool, 0, 0, 42, [](int i) { return i; },
+            std::plus<>{}) == 42);
+    }
+
+    SECTION("Exceptions are propagated to the caller")
+    {
+        REQUIRE_THROWS_AS(
+            parallel_reduce(*pool, 0, 100, 0,
+                [](int i) -> int
+                {
+                    if (i == 99)
+                        throw std::runtime_error("Test");
+                    return i;
+                },
+                std::plus<>{}),
+            std::runtime_error);
+    }
+}
+
+TEST_CASE("parallel.h: Index arithmetic without signed overflow", "[parallel]")
+{
+    constexpr auto min = std::numeric_limits<int>::min();
+    constexpr auto max = std::numeric_limits<int>::max();
+
+    REQUIRE(detail::get_index_distance(min, max) == 0xffff'ffffu);
+    REQUIRE(detail::get_index_distance(-5, 5) == 10u);
+    REQUIRE(detail::get_index_distance(std::numeric_limits<std::int16_t>::min(),
+        std::numeric_limits<std::int16_t>::max()) == 0xffffu);
+    REQUIRE(detail::get_nth_index(min, 0xffff'fffeu) == max - 1);
+    REQUIRE(detail::get_nth_index(-5, 7u) == 2);
+}
+